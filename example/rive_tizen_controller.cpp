@@ -28,11 +28,7 @@ static void deleteWindow(void* data, Evas_Object* obj, void* ev)
 
 static void drawToCanvas(void* data, Eo* obj)
 {
-	auto canvas = controller.getCanvas();
-	if (canvas->draw() == tvg::Result::Success)
-	{
-		canvas->sync();
-	}
+	controller.draw();
 }
 
 static bool isRiveFile(const char* filename)
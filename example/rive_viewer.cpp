@@ -1,3 +1,8 @@
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <thread>
 #include <dirent.h>
 #include <algorithm>
@@ -17,6 +22,7 @@ using namespace std;
 
 static unique_ptr<tvg::SwCanvas> canvas = nullptr;
 static rive::File* currentFile = nullptr;
+static atomic<rive::File*> pendingFile{nullptr};
 static rive::Artboard* artboard = nullptr;
 static rive::LinearAnimationInstance* animationInstance = nullptr;
 static Ecore_Animator *animator = nullptr;
@@ -25,6 +31,52 @@ static vector<std::string> rivefiles;
 static double lastTime;
 static Eo* statePopup = nullptr;
 
+// Imports and deletes files off the UI thread, one job at a time, joined in cleanExample().
+static thread fileWorker;
+static mutex fileMutex;
+static condition_variable fileWake;
+static deque<function<void()>> fileJobs;
+static bool fileWorkerStopping = false;
+// Bumped by every load request, superseded imports are skipped or dropped.
+static atomic<unsigned> loadGeneration{0};
+
+static void runFileJobs()
+{
+    unique_lock<mutex> lock(fileMutex);
+    while (true)
+    {
+       fileWake.wait(lock, []() { return fileWorkerStopping || !fileJobs.empty(); });
+       if (fileJobs.empty()) return;
+       auto job = move(fileJobs.front());
+       fileJobs.pop_front();
+       lock.unlock();
+       job();
+       lock.lock();
+    }
+}
+
+static void postFileJob(function<void()> job)
+{
+    {
+       lock_guard<mutex> lock(fileMutex);
+       fileJobs.push_back(move(job));
+       if (!fileWorker.joinable()) fileWorker = thread(runFileJobs);
+    }
+    fileWake.notify_one();
+}
+
+static void stopFileWorker()
+{
+    // Pending imports are skipped, pending deletes still run.
+    ++loadGeneration;
+    {
+       lock_guard<mutex> lock(fileMutex);
+       fileWorkerStopping = true;
+    }
+    fileWake.notify_one();
+    if (fileWorker.joinable()) fileWorker.join();
+}
+
 static void deleteWindow(void *data, Evas_Object *obj, void *ev)
 {
     elm_exit();
@@ -51,13 +103,11 @@ static void initAnimation(int index)
     if (animation) animationInstance = new rive::LinearAnimationInstance(animation);
 }
 
-static void loadRiveFile(const char* filename)
+static rive::File* importRiveFile(const char* filename)
 {
-    lastTime = ecore_time_get();    //Check point
-    canvas->clear();            //Clear Canvas Buffer
-
     // Load Rive File
     FILE* fp = fopen(filename, "r");
+    if (!fp) return nullptr;
 
     fseek(fp, 0, SEEK_END);
     size_t length = ftell(fp);
@@ -67,19 +117,45 @@ static void loadRiveFile(const char* filename)
     if (fread(bytes, 1, length, fp) != length)
     {
        delete[] bytes;
+       fclose(fp);
        fprintf(stderr, "failed to read all of %s\n", filename);
-       return;
+       return nullptr;
     }
+    fclose(fp);
 
     auto reader = rive::BinaryReader(bytes, length);
     rive::File* file = nullptr;
     auto result = rive::File::import(reader, &file);
+    delete[] bytes;
+
     if (result != rive::ImportResult::success)
     {
-       delete[] bytes;
        fprintf(stderr, "failed to import %s\n", filename);
-       return;
+       return nullptr;
     }
+    return file;
+}
+
+static void loadRiveFile(const char* filename)
+{
+    // Import off the UI thread, animationLoop() swaps the file in when it's ready.
+    auto generation = ++loadGeneration;
+    string name = filename;
+    postFileJob([generation, name]() {
+        if (generation != loadGeneration) return;
+        auto file = importRiveFile(name.c_str());
+        if (!file) return;
+        if (generation != loadGeneration) delete file;
+        else delete pendingFile.exchange(file);
+    });
+}
+
+static void swapRiveFile()
+{
+    auto file = pendingFile.exchange(nullptr);
+    if (!file) return;
+
+    lastTime = ecore_time_get();    //Check point
 
     artboard = file->artboard();
     artboard->advance(0.0f);
@@ -90,10 +166,10 @@ static void loadRiveFile(const char* filename)
     auto animation = artboard->firstAnimation();
     if (animation) animationInstance = new rive::LinearAnimationInstance(animation);
 
-    delete currentFile;
+    // The canvas was cleared this frame, nothing refers to the old file anymore.
+    auto old = currentFile;
+    postFileJob([old]() { delete old; });
     currentFile = file;
-
-    delete[] bytes;
 }
 
 static void fileClickedCb (void *data, Evas_Object *obj, void *event_info)
@@ -131,6 +207,7 @@ static std::vector<std::string> riveFiles(const std::string &dirName)
 Eina_Bool animationLoop(void *data)
 {
     canvas->clear();
+    swapRiveFile();
 
     double currentTime = ecore_time_get();
     float elapsed = currentTime - lastTime;
@@ -168,6 +245,9 @@ static void runExample(uint32_t* buffer)
 
 static void cleanExample()
 {
+    stopFileWorker();
+    delete pendingFile.exchange(nullptr);
+
     delete animationInstance;
     animationInstance = nullptr;
 }
@@ -28,6 +28,7 @@ static Eo* view = nullptr;
 static vector<std::string> rivefiles;
 static double lastTime;
 static Eo* statePopup = nullptr;
+static rive_tizen::ComponentIndex components;
 
 std::string currentColorInstance;
 Eo *entryR, *entryG, *entryB, *entryA;
@@ -82,6 +83,7 @@ static void loadRiveFile(const char* filename)
 
     artboard = file->artboard();
     artboard->advance(0.0f);
+    components.build(artboard);
 
     delete animationInstance;
     animationInstance = nullptr;
@@ -196,7 +198,7 @@ static void applyCb(void *data, Evas_Object *obj EINA_UNUSED, void *event_info E
 
    printf("current vector instance: %s r:%d g:%d b:%d a:%d\n", currentColorInstance.c_str(), atoi(r), atoi(g), atoi(b), atoi(a));
 
-   auto colorInstance = artboard->find<rive::Fill>(currentColorInstance.c_str());
+   auto colorInstance = components.handle<rive::Fill>(currentColorInstance).get();
    if (colorInstance)
      colorInstance->paint()->as<rive::SolidColor>()->colorValue(rive::colorARGB(atoi(a), atoi(r), atoi(g), atoi(b)));
 }
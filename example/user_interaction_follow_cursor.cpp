@@ -23,6 +23,10 @@ static rive::LinearAnimationInstance* animationInstance;
 static Ecore_Animator *animator = nullptr;
 static Eo* view = nullptr;
 static double lastTime;
+static rive_tizen::ComponentIndex components;
+static rive_tizen::ComponentHandle<rive::Node> nodeRoot;
+static rive_tizen::ComponentHandle<rive::Node> nodeSpark;
+static rive_tizen::PropertyBatch properties;
 
 static void deleteWindow(void *data, Evas_Object *obj, void *ev)
 {
@@ -66,6 +70,11 @@ static void loadRiveFile(const char* filename)
     artboard = file->artboard();
     artboard->advance(0.0f);
 
+    // Resolve the nodes once, mouse moves only use the handles.
+    components.build(artboard);
+    nodeRoot = components.handle<rive::Node>("root");
+    nodeSpark = components.handle<rive::Node>("spark");
+
     delete animationInstance;
     animationInstance = nullptr;
 
@@ -88,6 +97,9 @@ Eina_Bool animationLoop(void *data)
 
     if (!artboard) return ECORE_CALLBACK_RENEW;
 
+    // Only the last cursor position since the previous frame gets applied.
+    properties.apply();
+
     animationInstance->advance(elapsed);
     animationInstance->apply(artboard);
 
@@ -137,20 +149,15 @@ static void mouseMoveCb(void *data, Evas *evas EINA_UNUSED, Evas_Object *obj, vo
    // 250 is the constant for align y center
    int posy = ev->cur.canvas.y - viewy + 250;
 
-   // Get the root instance
-   auto root = artboard->find("root");
-   auto nodeRoot = root->as<rive::Node>();
-
-   auto spark = artboard->find("spark");
-   auto nodeSpark = spark->as<rive::Node>();
+   if (!nodeRoot || !nodeSpark) return;
 
    // Set root position
-   nodeRoot->x(posx);
-   nodeRoot->y(posy);
+   properties.set(nodeRoot, &rive::NodeBase::x, posx);
+   properties.set(nodeRoot, &rive::NodeBase::y, posy);
 
    // Set spark position, 400 is the constant
-   nodeSpark->x(posx - 400);
-   nodeSpark->y(posy);
+   properties.set(nodeSpark, &rive::NodeBase::x, posx - 400);
+   properties.set(nodeSpark, &rive::NodeBase::y, posy);
 }
 
 static void setupScreen(uint32_t* buffer)
@@ -1,4 +1,16 @@
 #include <iostream>
+#include <atomic>
+#include <cstring>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "file.hpp"
 #include "math/aabb.hpp"
@@ -10,27 +22,563 @@
 
 RIVE_EXPORT void rive_tizen_print();
 
+namespace rive
+{
+	class Component;
+	class RenderPath;
+	class Shape;
+}
+
 namespace rive_tizen
 {
+	class ComponentIndex;
+
+	// Reference to a named component, resolved once and reused for every
+	// read or write. It goes null when its index is rebuilt for another
+	// artboard, instead of dangling.
+	template<typename T>
+	class ComponentHandle
+	{
+	public:
+		ComponentHandle() : m_Index(nullptr), m_Component(nullptr), m_Generation(0) {}
+		ComponentHandle(const ComponentIndex* index, T* component, uint32_t generation) :
+			m_Index(index), m_Component(component), m_Generation(generation) {}
+
+		inline T* get() const;
+		T* operator->() const { return get(); }
+		explicit operator bool() const { return get() != nullptr; }
+
+	private:
+		template<typename> friend class ComponentHandle;
+		friend class PropertyBatch;
+
+		const ComponentIndex* m_Index;
+		T* m_Component;
+		uint32_t m_Generation;
+	};
+
+	// Name to component hash index of an artboard, built once instead of the
+	// linear scan with string compares Artboard::find does on every call.
+	// Like Artboard::find, the first component with a given name wins.
+	class ComponentIndex
+	{
+	public:
+		ComponentIndex();
+
+		// Indexes the artboard and invalidates every handle given out before.
+		void build(rive::Artboard* artboard);
+		void clear();
+
+		rive::Component* find(const std::string& name) const;
+
+		template<typename T>
+		ComponentHandle<T> handle(const std::string& name) const
+		{
+			auto component = find(name);
+			if (component == nullptr || component->is<T>() == false)
+			{
+				return ComponentHandle<T>();
+			}
+			return ComponentHandle<T>(this, component->as<T>(), m_Generation);
+		}
+
+		// Safe to read from any thread, handles are checked when writes are queued.
+		uint32_t generation() const { return m_Generation.load(std::memory_order_acquire); }
+
+	private:
+		std::unordered_map<std::string, rive::Component*> m_Components;
+		std::atomic<uint32_t> m_Generation;
+	};
+
+	template<typename T>
+	T* ComponentHandle<T>::get() const
+	{
+		return m_Index && m_Index->generation() == m_Generation ? m_Component : nullptr;
+	}
+
+	// Property writes queued between frames and applied in one pass. Writes
+	// to the same property of the same component coalesce, the last one wins,
+	// so each property is set and each component dirtied once per apply()
+	// however many updates arrived. Properties are named by their generated
+	// setters, e.g. &rive::NodeBase::x, so a write to a component without
+	// that property or with a value of another type does not compile.
+	// Safe to fill from any thread.
+	class PropertyBatch
+	{
+		template<typename V>
+		struct Identity
+		{
+			using Type = V;
+		};
+
+	public:
+		template<typename T, typename Owner, typename V>
+		void set(const ComponentHandle<T>& handle, void (Owner::*setter)(V),
+			typename Identity<V>::Type value)
+		{
+			static_assert(std::is_base_of<Owner, T>::value, "the component has no such property");
+			static_assert(std::is_trivially_copyable<V>::value && sizeof(V) <= sizeof(uint64_t),
+				"only scalar properties can be batched");
+			static_assert(sizeof(setter) <= sizeof(Setter), "unexpected member pointer size");
+			if (handle.get() == nullptr)
+			{
+				return;
+			}
+			Write write = {handle.m_Index, handle.m_Component, handle.m_Generation, &invoke<Owner, V>, {}, 0};
+			std::memcpy(write.setter.bytes, &setter, sizeof(setter));
+			std::memcpy(&write.value, &value, sizeof(value));
+			queue(write);
+		}
+
+		// Sets every queued property, skipping components whose handles went
+		// stale, and empties the batch.
+		void apply();
+		void clear();
+		size_t size();
+
+	private:
+		// Bytes of a member function pointer, compared to coalesce writes.
+		struct Setter
+		{
+			unsigned char bytes[sizeof(void (rive::Core::*)())];
+
+			bool operator==(const Setter& other) const
+			{
+				return std::memcmp(bytes, other.bytes, sizeof(bytes)) == 0;
+			}
+		};
+		struct Write
+		{
+			const ComponentIndex* index;
+			rive::Core* component;
+			uint32_t generation;
+			void (*apply)(const Write& write);
+			Setter setter;
+			uint64_t value;
+		};
+
+		template<typename Owner, typename V>
+		static void invoke(const Write& write)
+		{
+			void (Owner::*setter)(V);
+			V value;
+			std::memcpy(&setter, write.setter.bytes, sizeof(setter));
+			std::memcpy(&value, &write.value, sizeof(value));
+			(static_cast<Owner*>(write.component)->*setter)(value);
+		}
+		void queue(const Write& write);
+
+		using SlotKey = std::pair<const rive::Core*, Setter>;
+		struct SlotHash
+		{
+			size_t operator()(const SlotKey& key) const
+			{
+				size_t hash = std::hash<const rive::Core*>()(key.first);
+				for (auto byte : key.second.bytes)
+				{
+					hash ^= byte + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+				}
+				return hash;
+			}
+		};
+
+		std::mutex m_Mutex;
+		std::vector<Write> m_Writes;
+		// Position in m_Writes of the pending write of each (component, setter).
+		std::unordered_map<SlotKey, size_t, SlotHash> m_Slots;
+		std::vector<Write> m_Applying;
+	};
+
+	class LoadedFile;
+	struct AsyncLoad;
+	struct MemoryUsage;
+	class Upscaler;
+
+	// Independent copy of an artboard, for showing it more than once with
+	// separate animation state. An instance imports only the components of
+	// its artboard: transforms, colors and other mutable state are its own,
+	// while the animations are borrowed from the loaded file (keyed objects
+	// resolve by component id, which instances share).
+	//
+	// Only the animations are shared: keyed objects, keyed properties and
+	// keyframes. Everything else is copied per instance, component names and
+	// path vertices included, since every vertex is a component of its own.
+	// Per instance, roughly:
+	//
+	//   components * 192 bytes      nodes, shapes, paths, vertices, paints
+	//   + names of the components   heap of the names longer than SSO
+	//   + render paths              one per path plus two per shape, and
+	//                               their path data unless pooled
+	//   + render paints             one per fill and stroke, not counted
+	//
+	// The component count grows with importedBytes(), the size of the slice
+	// the instance was imported from. memoryUsage() measures an instance.
+	// Identical path geometry is pooled by the renderer once it stops
+	// changing. An instance keeps the file it came from alive.
+	class ArtboardInstance
+	{
+	public:
+		~ArtboardInstance();
+
+		rive::Artboard* artboard() const { return m_Artboard; }
+		size_t animationCount() const;
+		// Animations to apply to artboard().
+		rive::LinearAnimation* animation(size_t index) const;
+		rive::LinearAnimation* animation(const char* name) const;
+		size_t importedBytes() const { return m_ImportedBytes; }
+		// Heap of this instance alone, filling objects, strings and shapes.
+		// Pooled geometry is counted in full even when shared.
+		MemoryUsage memoryUsage() const;
+
+	private:
+		friend class Controller;
+		ArtboardInstance(std::shared_ptr<LoadedFile> source, size_t sourceIndex,
+			rive::File* file, size_t importedBytes);
+		// Instances are imported without animations and borrow the source's.
+		rive::Artboard* animationSource() const;
+
+		std::shared_ptr<LoadedFile> m_Source;
+		size_t m_SourceIndex;
+		std::unique_ptr<rive::File> m_File;
+		rive::Artboard* m_Artboard;
+		size_t m_ImportedBytes;
+	};
+
+	struct PointerEvent
+	{
+		enum class Type : uint8_t
+		{
+			down,
+			move,
+			up
+		};
+		Type type;
+		// Target buffer coordinates.
+		float x;
+		float y;
+	};
+
+	// Lock-free single producer, single consumer queue of pointer events,
+	// filled by the UI thread at input rate and drained by the render thread
+	// once per frame. Draining coalesces each run of moves into its last one,
+	// downs and ups are delivered in order.
+	class InputQueue
+	{
+	public:
+		static constexpr size_t Capacity = 256;
+
+		InputQueue();
+
+		// Producer side. The last slot is kept for a down or up, a flood of
+		// moves must not starve them. Moves past that go to a single overflow
+		// slot, each replacing the one before, so the freshest position is
+		// never lost. False when a down or up was dropped on a full queue.
+		bool push(PointerEvent::Type type, float x, float y);
+		// Consumer side.
+		void drain(const std::function<void(const PointerEvent&)>& handler);
+
+	private:
+		PointerEvent m_Events[Capacity];
+		// Free running counters, wrapped by masking. Head is written by the
+		// consumer, tail by the producer.
+		std::atomic<size_t> m_Head;
+		std::atomic<size_t> m_Tail;
+		// Overflow move, written by the producer under a sequence lock: the
+		// sequence is odd while a write is in progress. It goes before the
+		// event at position m_MoveAt, the tail when it was pushed.
+		std::atomic<size_t> m_MoveSequence;
+		std::atomic<float> m_MoveX;
+		std::atomic<float> m_MoveY;
+		std::atomic<size_t> m_MoveAt;
+		// Consumer side: sequence of the last overflow move delivered.
+		size_t m_MoveTaken;
+	};
+
+	struct QualityChange
+	{
+		uint64_t frame;
+		int tier;
+		// Averaged frame cost that led to the change, in milliseconds.
+		double cost;
+	};
+
+	// Steps through quality tiers to hold a frame time budget: down when the
+	// averaged frame cost stays over budget, back up once there has been
+	// headroom for a while. Tier 0 is full quality.
+	class QualityGovernor
+	{
+	public:
+		static const int MaxTier = 3;
+
+		QualityGovernor();
+
+		// Milliseconds per frame, 0 turns the governor off and restores tier 0.
+		void budget(double milliseconds);
+		double budget() const { return m_Budget; }
+		// Feeds the cost of a finished frame, true when the tier changed.
+		bool sample(double milliseconds);
+		int tier() const { return m_Tier; }
+		// The most recent tier changes, oldest first.
+		const std::vector<QualityChange>& history() const { return m_History; }
+
+	private:
+		void change(int tier);
+
+		double m_Budget;
+		double m_Average;
+		int m_Tier;
+		int m_Over;
+		int m_Under;
+		uint64_t m_Frame;
+		std::vector<QualityChange> m_History;
+	};
+
+	// Memory held for Rive content, in bytes, good for telling Rive's share of
+	// the footprint apart and for spotting growth. Each figure says whether
+	// it is measured or estimated; thorvg's private data behind shapes and
+	// gradients is a fixed estimate added to their measured path and stops.
+	struct MemoryUsage
+	{
+		// Measured: source bytes mapped or streamed in, kept for importing.
+		size_t fileBytes = 0;
+		// Estimated: runtime components of imported artboards and instances,
+		// at an average size per component.
+		size_t objects = 0;
+		// Measured: animations, keyed objects, keyed properties and keyframes
+		// of imported artboards, counted while indexing and sized by type.
+		// State machine contents are not included.
+		size_t animations = 0;
+		// Measured: heap of the names of artboards, components and animations.
+		size_t strings = 0;
+		// Measured: path data of thorvg shapes owned by render paths, stroke
+		// caches included. Pooled geometry shared with another controller is
+		// counted by both, the process wide report counts it once.
+		size_t shapes = 0;
+		// Measured: gradients of the paints drawn in the last frame. The
+		// process wide report counts every live gradient instead.
+		size_t fills = 0;
+		// Measured: paint copies of the frames in flight.
+		size_t frames = 0;
+		// Measured: static layers and the render scale buffer.
+		size_t rasterCaches = 0;
+		// Measured: target buffers handed to setTargetBuffer(), owned by the caller.
+		size_t targetBuffers = 0;
+
+		size_t total() const
+		{
+			return fileBytes + objects + animations + strings + shapes + fills + frames + rasterCaches +
+				targetBuffers;
+		}
+	};
+
+	// How much trimMemory() gives back, each level including the lighter ones.
+	enum class TrimLevel
+	{
+		// Static layers, stroke caches, frame paints and the hit index.
+		Caches,
+		// Path data of idle controllers.
+		Shapes,
+		// Files of idle controllers.
+		Files,
+	};
+
 	class Controller
 	{
 	public:
 		Controller();
-		bool loadFile(const char* fileName);
+		~Controller();
+		// With lazy set, only the artboard byte ranges are indexed at load and
+		// each artboard is imported the first time it is requested.
+		bool loadFile(const char* fileName, bool lazy = false);
+		// Imports on the library's file worker, joined at exit, while the
+		// current file keeps rendering. The new file replaces the current one
+		// at the start of the next render() and callback runs there, on the
+		// render thread. A newer request supersedes a pending one, which
+		// stops before its next artboard import and whose callback gets false.
+		void loadFileAsync(const char* fileName, std::function<void(bool)> callback, bool lazy = false);
+		// Streams a file in chunks from a pipe, socket or decompressor. Artboards
+		// are imported as their bytes arrive. The current file keeps rendering
+		// until the components of the first artboard are in, then the stream
+		// replaces it and drawable is called. When the selected artboard was
+		// drawn before its animations arrived, it is replaced by one with them
+		// and drawable is called again. Call these between frames, on the
+		// render thread.
+		bool beginStream(std::function<void()> drawable);
+		// Returns false on malformed data, which aborts the stream.
+		bool feed(const uint8_t* bytes, size_t length);
+		bool endStream();
+		// Directory for index caches. When set, loadFile writes the artboard
+		// index of a file next to it and later loads of the unchanged file
+		// skip reading and indexing the source; lazy loads then only read the
+		// artboards they import.
+		void setCacheDir(const char* path);
 		bool setTargetBuffer(uint32_t* buffer, int width, int height);
 		bool applyAnimation(char* animationName, bool on);
 		double getDuration();
 		tvg::SwCanvas* getCanvas();
 		bool render(double time);
 
+		// Artboards of the loaded file, valid until another file replaces it.
+		// Handing one out keeps trimMemory() from unloading the file.
 		rive::Artboard* getArtboard();
+		rive::Artboard* getArtboard(const char* name);
+		rive::Artboard* getArtboardAt(size_t index);
+		size_t getArtboardCount();
+		// Changes the artboard rendered by this controller.
+		bool selectArtboard(const char* name);
+		bool selectArtboardAt(size_t index);
+		// Creates an instance of an artboard of the loaded file, nullptr when
+		// the artboard doesn't exist.
+		std::unique_ptr<ArtboardInstance> createInstance(const char* name);
+		std::unique_ptr<ArtboardInstance> createInstanceAt(size_t index);
+		// Topmost shape drawn at (x, y), in target buffer coordinates, as of the
+		// last rendered frame. nullptr when nothing is hit. The first call turns
+		// on recording of the draws, so it only finds shapes from the next frame on.
+		rive::Shape* hitTest(float x, float y);
+		// Components of the selected artboard by name. Rebuilt whenever the
+		// artboard changes, which invalidates the handles taken from it.
+		const ComponentIndex& components() const { return m_Components; }
+		// Writes queued here are applied at the start of the next render().
+		PropertyBatch& properties() { return m_Properties; }
+		// Pointer events pushed here from the UI thread reach handler at the
+		// start of the next render(), coalesced per frame.
+		InputQueue& input() { return m_Input; }
+		void setInputHandler(std::function<void(const PointerEvent&)> handler);
+		// Draws that stop changing for a few frames are rasterized once into
+		// static layers at the target size and blitted afterwards. Off by
+		// default: content that holds still briefly between changes pays for
+		// baking layers it drops again, turn it on for mostly static scenes.
+		void setLayerBaking(bool enabled);
+		// Rasterizes the last rendered frame into the target buffer. Same as
+		// drawing the canvas, but timed for the quality governor and required
+		// below a render scale of 1, where it also upscales into the target.
+		bool draw();
+		// Rasterizes at a fraction of the target resolution, in (0, 1], and
+		// bilinearly upscales into the target buffer. Takes effect from the
+		// next render(), without reallocating.
+		void setRenderScale(float scale);
+		float getRenderScale() const { return m_RenderScale; }
+		// Opt-in: holds render() + draw() within the given milliseconds by
+		// trading quality, 0 turns it off. Tier 1 skips strokes thinner than
+		// a pixel, tier 2 also skips draws smaller than 2 pixels and tier 3
+		// also renders at 3/4 of the render scale.
+		void setFrameBudget(double milliseconds);
+		int getQualityTier() const { return m_Governor.tier(); }
+		const std::vector<QualityChange>& getQualityHistory() const { return m_Governor.history(); }
+		// Draws another artboard into the target in the same pass as the
+		// selected one, fitted into frame, in target buffer coordinates.
+		// Placements with a negative z are drawn below the selected artboard
+		// and the others above it, by z and then in order of placement. The
+		// instance may come from any controller. Its animations are applied
+		// by the caller and render() advances it. Returns the placement id,
+		// -1 for a null instance.
+		int place(std::unique_ptr<ArtboardInstance> instance, const rive::AABB& frame, int z = 0,
+			rive::Fit fit = rive::Fit::contain);
+		ArtboardInstance* getPlacement(int id);
+		bool movePlacement(int id, const rive::AABB& frame, int z);
+		bool removePlacement(int id);
+		// Memory held by this controller: its file, placements, renderer and
+		// buffers. A file shared with another controller is counted by both.
+		// Controllers must not render meanwhile.
+		MemoryUsage memoryUsage();
+		// Every live controller, each file counted once, plus the shapes and
+		// fills of the whole process. Controllers must not render meanwhile.
+		static MemoryUsage processMemoryUsage();
+		// Gives memory back under pressure, everything dropped is rebuilt by
+		// the next render(). Idle controllers, hidden or without a render for
+		// a second, also release their path data and, at TrimLevel::Files,
+		// unload their file if it was loaded from a path and no instance holds
+		// it. A file the application got artboards or shapes of, through the
+		// getArtboard calls or hitTest(), stays loaded: those pointers must
+		// not dangle. Component handles go null on a reload instead, and the
+		// file is reloaded lazily by the next render().
+		void trimMemory(TrimLevel level);
+		// Trims every live controller, for system low memory notifications.
+		// Call it from the thread the controllers render on.
+		static void trimAllMemory(TrimLevel level);
+		// Hidden controllers count as idle for trimMemory().
+		void setVisible(bool visible);
 
 	private:
-		rive::File* m_File;
+		void unloadFile();
+		void swapFile(unique_ptr<LoadedFile> file);
+		void cancelAsyncLoad();
+		void completeAsyncLoad();
+		void cancelStream();
+		// Index of the selected artboard when it is streamed without its
+		// animations yet, -1 otherwise.
+		int shownPartial();
+		void streamReady(int partial);
+		void mapShapes();
+		void mapShapes(rive::Artboard* artboard);
+		void setArtboard(rive::Artboard* artboard);
+		void applyQuality();
+		void applyScale();
+		void sortPlacements();
+		bool idle() const;
+		void trimPaths(rive::Artboard* artboard, bool pathData);
+		void reloadFile();
+		void addUsage(MemoryUsage& usage, std::unordered_set<const LoadedFile*>& files);
+		void drawArtboard(rive::Artboard* artboard, const rive::AABB& frame, rive::Fit fit, double elapsed);
+
+		struct Placement
+		{
+			int id;
+			std::unique_ptr<ArtboardInstance> instance;
+			rive::AABB frame;
+			int z;
+			rive::Fit fit;
+		};
+
+		std::shared_ptr<LoadedFile> m_File;
+		std::shared_ptr<AsyncLoad> m_AsyncLoad;
+		// File being streamed, owned by m_Stream until it is drawable and by
+		// m_File after that.
+		LoadedFile* m_Streaming;
+		unique_ptr<LoadedFile> m_Stream;
+		std::function<void()> m_StreamDrawable;
+		// Render paths of the selected and placed artboards back to their
+		// shapes, for hitTest.
+		std::unordered_map<const rive::RenderPath*, rive::Shape*> m_PathShapes;
+		bool m_ShapesMapped;
+		// Drawing order: by z, then by id.
+		std::vector<Placement> m_Placements;
+		int m_NextPlacement;
+		ComponentIndex m_Components;
+		PropertyBatch m_Properties;
+		InputQueue m_Input;
+		bool m_LayerBaking;
+		QualityGovernor m_Governor;
+		// Cost of the frame in flight: render() plus the draw() that follows.
+		double m_FrameCost;
+		std::function<void(const PointerEvent&)> m_InputHandler;
+		std::string m_CacheDir;
+		// Path the current file was loaded from, empty for streams.
+		std::string m_FileName;
+		// Trimmed at TrimLevel::Files, reloaded by the next render().
+		bool m_Reload;
+		// Artboard or shape pointers into m_File were handed out, it can't be
+		// trimmed until it is replaced.
+		bool m_PointersOut;
+		std::string m_ReloadArtboard;
+		bool m_Visible;
+		std::chrono::steady_clock::time_point m_LastRender;
+		rive::Artboard* m_Artboard;
 		unique_ptr<tvg::SwCanvas> m_Canvas;
+		// Declared after m_Canvas: must release its paints before the canvas dies.
+		unique_ptr<rive::TvgRenderer> m_Renderer;
 		bool m_Is_Fileloaded;
 
+		uint32_t* m_Buffer;
 		int m_Width;
 		int m_Height;
+		float m_RenderScale;
+		// Canvas size, the target scaled by the render scale and the governor.
+		int m_ScaledWidth;
+		int m_ScaledHeight;
+		// Canvas target below scale 1. Sized for the full target once, so any
+		// smaller scale fits without reallocating.
+		std::vector<uint32_t> m_ScaledBuffer;
+		unique_ptr<Upscaler> m_Upscaler;
 	};
 }
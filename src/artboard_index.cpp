@@ -0,0 +1,323 @@
+#include <cstring>
+
+#include "artboard_index.hpp"
+#include "file.hpp"
+#include "core/binary_reader.hpp"
+#include "generated/core_registry.hpp"
+#include "generated/artboard_base.hpp"
+#include "generated/component_base.hpp"
+#include "generated/animation/linear_animation_base.hpp"
+#include "generated/animation/state_machine_base.hpp"
+#include "generated/animation/keyed_object_base.hpp"
+#include "generated/animation/keyed_property_base.hpp"
+#include "generated/animation/keyframe_double_base.hpp"
+#include "generated/animation/keyframe_color_base.hpp"
+#include "generated/animation/keyframe_id_base.hpp"
+#include "core/field_types/core_uint_type.hpp"
+#include "core/field_types/core_string_type.hpp"
+#include "core/field_types/core_double_type.hpp"
+#include "core/field_types/core_color_type.hpp"
+
+using namespace rive_tizen;
+
+// Reads a LEB128 unsigned integer, false when it runs past the end.
+static bool readVarUint(const uint8_t* bytes, size_t length, size_t& position, uint64_t& value)
+{
+	value = 0;
+	unsigned shift = 0;
+	while (position < length)
+	{
+		uint8_t byte = bytes[position++];
+		value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+		if ((byte & 0x80) == 0)
+		{
+			return true;
+		}
+		shift += 7;
+		if (shift >= 64)
+		{
+			return false;
+		}
+	}
+	return false;
+}
+
+ArtboardIndex::ArtboardIndex()
+{
+	reset();
+}
+
+void ArtboardIndex::reset()
+{
+	m_Position = 0;
+	m_HeaderEnd = 0;
+	m_Finished = false;
+	m_TocFieldIds.clear();
+	m_Artboards.clear();
+}
+
+bool ArtboardIndex::readHeader(const uint8_t* bytes, size_t length)
+{
+	if (length < 4)
+	{
+		return true;
+	}
+	if (memcmp(bytes, "RIVE", 4) != 0)
+	{
+		return false;
+	}
+
+	size_t position = 4;
+	uint64_t value;
+	// Major version, minor version and file id.
+	for (int i = 0; i < 3; i++)
+	{
+		if (!readVarUint(bytes, length, position, value))
+		{
+			return true;
+		}
+	}
+
+	std::vector<uint64_t> keys;
+	while (true)
+	{
+		if (!readVarUint(bytes, length, position, value))
+		{
+			return true;
+		}
+		if (value == 0)
+		{
+			break;
+		}
+		keys.push_back(value);
+	}
+
+	// Field types are packed 2 bits each, 4 per 32 bit word.
+	uint32_t word = 0;
+	int bit = 8;
+	for (auto key : keys)
+	{
+		if (bit == 8)
+		{
+			if (length - position < 4)
+			{
+				return true;
+			}
+			word = bytes[position] | bytes[position + 1] << 8 | bytes[position + 2] << 16 |
+				static_cast<uint32_t>(bytes[position + 3]) << 24;
+			position += 4;
+			bit = 0;
+		}
+		m_TocFieldIds[key] = (word >> bit) & 3;
+		bit += 2;
+	}
+
+	m_HeaderEnd = position;
+	m_Position = position;
+	return true;
+}
+
+int ArtboardIndex::fieldId(uint64_t propertyKey) const
+{
+	int id = rive::CoreRegistry::propertyFieldId(static_cast<int>(propertyKey));
+	if (id != -1)
+	{
+		return id;
+	}
+	auto itr = m_TocFieldIds.find(propertyKey);
+	return itr == m_TocFieldIds.end() ? -1 : itr->second;
+}
+
+bool ArtboardIndex::scan(const uint8_t* bytes, size_t length)
+{
+	if (!headerRead())
+	{
+		if (!readHeader(bytes, length))
+		{
+			return false;
+		}
+		if (!headerRead())
+		{
+			return true;
+		}
+	}
+
+	while (m_Position < length)
+	{
+		size_t position = m_Position;
+		uint64_t typeKey;
+		if (!readVarUint(bytes, length, position, typeKey))
+		{
+			return true;
+		}
+
+		std::string name;
+		while (true)
+		{
+			uint64_t propertyKey;
+			if (!readVarUint(bytes, length, position, propertyKey))
+			{
+				return true;
+			}
+			if (propertyKey == 0)
+			{
+				break;
+			}
+
+			uint64_t value;
+			switch (fieldId(propertyKey))
+			{
+				case rive::CoreUintType::id:
+					if (!readVarUint(bytes, length, position, value))
+					{
+						return true;
+					}
+					break;
+				case rive::CoreStringType::id:
+					if (!readVarUint(bytes, length, position, value))
+					{
+						return true;
+					}
+					// A malformed length must not wrap position around.
+					if (value > length - position)
+					{
+						return true;
+					}
+					if (typeKey == rive::ArtboardBase::typeKey &&
+						propertyKey == rive::ComponentBase::namePropertyKey)
+					{
+						name.assign(reinterpret_cast<const char*>(bytes + position), value);
+					}
+					position += value;
+					break;
+				case rive::CoreDoubleType::id:
+				case rive::CoreColorType::id:
+					if (length - position < 4)
+					{
+						return true;
+					}
+					position += 4;
+					break;
+				default:
+					// Unknown property missing from the ToC, same as the importer.
+					return false;
+			}
+		}
+
+		if (typeKey == rive::ArtboardBase::typeKey)
+		{
+			if (!m_Artboards.empty())
+			{
+				m_Artboards.back().end = m_Position;
+			}
+			m_Artboards.push_back({name, m_Position, 0, 0});
+		}
+		else if (!m_Artboards.empty())
+		{
+			auto& artboard = m_Artboards.back();
+			switch (typeKey)
+			{
+				case rive::LinearAnimationBase::typeKey:
+					artboard.animations++;
+					if (artboard.animationStart == 0)
+					{
+						artboard.animationStart = m_Position;
+					}
+					break;
+				case rive::StateMachineBase::typeKey:
+					if (artboard.animationStart == 0)
+					{
+						artboard.animationStart = m_Position;
+					}
+					break;
+				case rive::KeyedObjectBase::typeKey:
+					artboard.keyedObjects++;
+					break;
+				case rive::KeyedPropertyBase::typeKey:
+					artboard.keyedProperties++;
+					break;
+				case rive::KeyFrameDoubleBase::typeKey:
+				case rive::KeyFrameColorBase::typeKey:
+				case rive::KeyFrameIdBase::typeKey:
+					artboard.keyFrames++;
+					break;
+			}
+		}
+		m_Position = position;
+	}
+	return true;
+}
+
+void ArtboardIndex::finish(size_t length)
+{
+	if (!m_Artboards.empty() && m_Artboards.back().end == 0)
+	{
+		m_Artboards.back().end = length;
+	}
+	m_Finished = true;
+}
+
+bool ArtboardIndex::restore(size_t headerEnd, std::vector<ArtboardRange> artboards)
+{
+	reset();
+	if (headerEnd == 0 || artboards.empty())
+	{
+		return false;
+	}
+	m_HeaderEnd = headerEnd;
+	m_Position = artboards.back().end;
+	m_Artboards = std::move(artboards);
+	m_Finished = true;
+	return true;
+}
+
+size_t ArtboardIndex::completeCount() const
+{
+	if (m_Finished || m_Artboards.empty())
+	{
+		return m_Artboards.size();
+	}
+	return m_Artboards.size() - 1;
+}
+
+int ArtboardIndex::find(const char* name) const
+{
+	for (size_t i = 0; i < m_Artboards.size(); i++)
+	{
+		if (m_Artboards[i].name == name)
+		{
+			return static_cast<int>(i);
+		}
+	}
+	return -1;
+}
+
+rive::File* ArtboardIndex::import(const uint8_t* bytes, size_t index, bool animations) const
+{
+	if (index >= count())
+	{
+		return nullptr;
+	}
+	// The components of an artboard still being scanned are complete once
+	// its animations start.
+	auto& range = m_Artboards[index];
+	if (index >= completeCount() && (animations || range.animationStart == 0))
+	{
+		return nullptr;
+	}
+
+	// Everything before the first artboard (header, ToC, backboard) is shared.
+	size_t end = animations || range.animationStart == 0 ? range.end : range.animationStart;
+	size_t preamble = m_Artboards[0].start;
+	std::vector<uint8_t> data(preamble + end - range.start);
+	memcpy(data.data(), bytes, preamble);
+	memcpy(data.data() + preamble, bytes + range.start, end - range.start);
+
+	auto reader = rive::BinaryReader(data.data(), data.size());
+	rive::File* file = nullptr;
+	if (rive::File::import(reader, &file) != rive::ImportResult::success)
+	{
+		return nullptr;
+	}
+	return file;
+}
@@ -0,0 +1,78 @@
+#ifndef _RIVE_TIZEN_ARTBOARD_INDEX_HPP_
+#define _RIVE_TIZEN_ARTBOARD_INDEX_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace rive
+{
+	class File;
+}
+
+namespace rive_tizen
+{
+	// Byte range of one artboard (the artboard object and everything that follows
+	// it up to the next artboard) in a .riv file.
+	struct ArtboardRange
+	{
+		std::string name;
+		size_t start;
+		size_t end;
+		// Start of the animations and state machines that follow the
+		// components, 0 when the artboard has none.
+		size_t animationStart;
+		// Animation objects of the range, counted by the scan for memory reports.
+		uint32_t animations = 0;
+		uint32_t keyedObjects = 0;
+		uint32_t keyedProperties = 0;
+		uint32_t keyFrames = 0;
+	};
+
+	// Index of the artboards in a .riv file, built by walking the object stream
+	// without creating any runtime objects.
+	class ArtboardIndex
+	{
+	public:
+		ArtboardIndex();
+
+		void reset();
+		// Scans the bytes appended since the last call. Stops before an object
+		// that isn't complete yet, returns false on malformed data.
+		bool scan(const uint8_t* bytes, size_t length);
+		// Closes the last artboard range at the end of the data.
+		void finish(size_t length);
+		// Takes a complete index built earlier, see IndexCache.
+		bool restore(size_t headerEnd, std::vector<ArtboardRange> artboards);
+
+		bool headerRead() const { return m_HeaderEnd > 0; }
+		size_t headerEnd() const { return m_HeaderEnd; }
+		size_t scanned() const { return m_Position; }
+		// Artboards whose byte range is known completely.
+		size_t completeCount() const;
+		size_t count() const { return m_Artboards.size(); }
+		const ArtboardRange& at(size_t index) const { return m_Artboards[index]; }
+		// Returns the artboard index or -1.
+		int find(const char* name) const;
+
+		// Imports a file holding only the preamble (header, backboard) and the
+		// given artboard, nullptr on failure. Without animations the artboard
+		// is cut before its first animation, leaving only its components, and
+		// the last artboard can be imported before its range is complete.
+		rive::File* import(const uint8_t* bytes, size_t index, bool animations = true) const;
+
+	private:
+		bool readHeader(const uint8_t* bytes, size_t length);
+		int fieldId(uint64_t propertyKey) const;
+
+		size_t m_Position;
+		size_t m_HeaderEnd;
+		bool m_Finished;
+		std::unordered_map<uint64_t, int> m_TocFieldIds;
+		std::vector<ArtboardRange> m_Artboards;
+	};
+}
+
+#endif
@@ -0,0 +1,44 @@
+#include "rive_tizen.hpp"
+#include "component.hpp"
+
+using namespace rive_tizen;
+
+ComponentIndex::ComponentIndex() : m_Generation(0)
+{
+}
+
+void ComponentIndex::build(rive::Artboard* artboard)
+{
+	clear();
+	if (artboard == nullptr)
+	{
+		return;
+	}
+
+	for (auto object : artboard->objects())
+	{
+		if (object == nullptr || object->is<rive::Component>() == false)
+		{
+			continue;
+		}
+		auto component = object->as<rive::Component>();
+		if (component->name().empty())
+		{
+			continue;
+		}
+		// emplace keeps the first one, the one Artboard::find would return.
+		m_Components.emplace(component->name(), component);
+	}
+}
+
+void ComponentIndex::clear()
+{
+	m_Components.clear();
+	m_Generation.fetch_add(1, std::memory_order_release);
+}
+
+rive::Component* ComponentIndex::find(const std::string& name) const
+{
+	auto itr = m_Components.find(name);
+	return itr == m_Components.end() ? nullptr : itr->second;
+}
@@ -0,0 +1,181 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#ifndef _WIN32
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "index_cache.hpp"
+#include "artboard_index.hpp"
+#include "mapped_file.hpp"
+#include "file.hpp"
+
+using namespace rive_tizen;
+
+// Bump whenever the layout below changes.
+static const uint32_t CacheFormatVersion = 3;
+
+struct CacheHeader
+{
+	char magic[4];
+	uint32_t formatVersion;
+	uint32_t riveMajorVersion;
+	uint32_t riveMinorVersion;
+	FileStamp source;
+	uint64_t headerEnd;
+	uint64_t artboardCount;
+	uint64_t payloadSize;
+	uint64_t payloadChecksum;
+};
+
+// Payload: one entry per artboard, then their names back to back.
+struct CacheEntry
+{
+	uint64_t start;
+	uint64_t end;
+	uint64_t animationStart;
+	uint64_t nameLength;
+	uint32_t animations;
+	uint32_t keyedObjects;
+	uint32_t keyedProperties;
+	uint32_t keyFrames;
+};
+
+uint64_t IndexCache::checksum(const uint8_t* bytes, size_t length)
+{
+	// FNV-1a
+	uint64_t hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < length; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+bool IndexCache::write(const char* path, const FileStamp& source, const ArtboardIndex& index)
+{
+#ifndef _WIN32
+	size_t count = index.completeCount();
+	if (count == 0 || source.size == 0)
+	{
+		return false;
+	}
+
+	std::vector<uint8_t> payload(sizeof(CacheEntry) * count);
+	for (size_t i = 0; i < count; i++)
+	{
+		auto& range = index.at(i);
+		CacheEntry entry = {range.start, range.end, range.animationStart, range.name.size(),
+			range.animations, range.keyedObjects, range.keyedProperties, range.keyFrames};
+		memcpy(payload.data() + sizeof(CacheEntry) * i, &entry, sizeof(entry));
+		payload.insert(payload.end(), range.name.begin(), range.name.end());
+	}
+
+	CacheHeader header{};
+	memcpy(header.magic, "RTZI", 4);
+	header.formatVersion = CacheFormatVersion;
+	header.riveMajorVersion = rive::File::majorVersion;
+	header.riveMinorVersion = rive::File::minorVersion;
+	header.source = source;
+	header.headerEnd = index.headerEnd();
+	header.artboardCount = count;
+	header.payloadSize = payload.size();
+	header.payloadChecksum = checksum(payload.data(), payload.size());
+
+	// A temp file of our own, renamed over the cache once complete.
+	std::string temp = std::string(path) + ".XXXXXX";
+	int fd = mkstemp(&temp[0]);
+	if (fd < 0)
+	{
+		return false;
+	}
+	FILE* fp = fdopen(fd, "wb");
+	if (fp == nullptr)
+	{
+		::close(fd);
+		unlink(temp.c_str());
+		return false;
+	}
+	bool written = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+		fwrite(payload.data(), 1, payload.size(), fp) == payload.size();
+	written = (fclose(fp) == 0) && written;
+	if (written == false || rename(temp.c_str(), path) != 0)
+	{
+		unlink(temp.c_str());
+		return false;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool IndexCache::read(const char* path, const FileStamp& source, ArtboardIndex& index)
+{
+#ifndef _WIN32
+	if (source.size == 0)
+	{
+		return false;
+	}
+	FILE* fp = fopen(path, "rb");
+	if (fp == nullptr)
+	{
+		return false;
+	}
+	CacheHeader header;
+	bool valid = fread(&header, sizeof(header), 1, fp) == 1 &&
+		memcmp(header.magic, "RTZI", 4) == 0 &&
+		header.formatVersion == CacheFormatVersion &&
+		header.riveMajorVersion == static_cast<uint32_t>(rive::File::majorVersion) &&
+		header.riveMinorVersion == static_cast<uint32_t>(rive::File::minorVersion) &&
+		header.source == source &&
+		header.artboardCount > 0 &&
+		header.artboardCount <= header.payloadSize / sizeof(CacheEntry) &&
+		header.headerEnd <= source.size;
+
+	// The header is only trusted as far as the file backs it.
+	struct stat info;
+	valid = valid && fstat(fileno(fp), &info) == 0 &&
+		static_cast<uint64_t>(info.st_size) == sizeof(header) + header.payloadSize;
+
+	std::vector<uint8_t> payload;
+	if (valid)
+	{
+		payload.resize(header.payloadSize);
+		valid = fread(payload.data(), 1, payload.size(), fp) == payload.size() &&
+			checksum(payload.data(), payload.size()) == header.payloadChecksum;
+	}
+	fclose(fp);
+	if (valid == false)
+	{
+		return false;
+	}
+
+	std::vector<ArtboardRange> artboards(header.artboardCount);
+	size_t names = sizeof(CacheEntry) * header.artboardCount;
+	for (size_t i = 0; i < artboards.size(); i++)
+	{
+		CacheEntry entry;
+		memcpy(&entry, payload.data() + sizeof(CacheEntry) * i, sizeof(entry));
+		// Ranges follow each other up to the end of the source.
+		uint64_t previous = i == 0 ? header.headerEnd : artboards[i - 1].end;
+		if (entry.start < previous || entry.end <= entry.start || entry.end > source.size ||
+			(entry.animationStart != 0 && (entry.animationStart <= entry.start || entry.animationStart > entry.end)) ||
+			entry.nameLength > payload.size() - names)
+		{
+			return false;
+		}
+		artboards[i] = {std::string(reinterpret_cast<const char*>(payload.data() + names), entry.nameLength),
+			entry.start, entry.end, entry.animationStart, entry.animations, entry.keyedObjects,
+			entry.keyedProperties, entry.keyFrames};
+		names += entry.nameLength;
+	}
+	return index.restore(header.headerEnd, std::move(artboards));
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,34 @@
+#ifndef _RIVE_TIZEN_INDEX_CACHE_HPP_
+#define _RIVE_TIZEN_INDEX_CACHE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rive_tizen
+{
+	class ArtboardIndex;
+	struct FileStamp;
+
+	// Artboard index of a .riv file kept on disk, so later loads neither read
+	// nor scan the source: with the source mapped, a lazy load only touches
+	// the pages of the artboards it imports. The cache is tied to the source's
+	// file stamp and the runtime version it was written with, and carries a
+	// checksum of its own payload.
+	//
+	// Note: Only the index is cached. rive::File is a graph of heap objects
+	// built by the rive-cpp importer, it can't be cached; every artboard is
+	// still imported object by object on use. An eager load imports them all
+	// and only saves the scan, a lazy one saves the scan and the pages of the
+	// artboards it never imports.
+	class IndexCache
+	{
+	public:
+		// Fills index from the cache at path, false if missing, stale or malformed.
+		static bool read(const char* path, const FileStamp& source, ArtboardIndex& index);
+		// Writes aside and renames, concurrent writers never mix their bytes.
+		static bool write(const char* path, const FileStamp& source, const ArtboardIndex& index);
+		static uint64_t checksum(const uint8_t* bytes, size_t length);
+	};
+}
+
+#endif
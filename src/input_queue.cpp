@@ -0,0 +1,101 @@
+#include "rive_tizen.hpp"
+
+using namespace rive_tizen;
+
+static_assert((InputQueue::Capacity & (InputQueue::Capacity - 1)) == 0, "capacity must be a power of two");
+
+InputQueue::InputQueue() : m_Head(0), m_Tail(0), m_MoveSequence(0), m_MoveX(0.0f), m_MoveY(0.0f),
+	m_MoveAt(0), m_MoveTaken(0)
+{
+}
+
+bool InputQueue::push(PointerEvent::Type type, float x, float y)
+{
+	size_t tail = m_Tail.load(std::memory_order_relaxed);
+	size_t head = m_Head.load(std::memory_order_acquire);
+
+	// Keep the last slot for a down or up, a flood of moves must not starve them.
+	size_t limit = type == PointerEvent::Type::move ? Capacity - 1 : Capacity;
+	if (tail - head >= limit)
+	{
+		if (type != PointerEvent::Type::move)
+		{
+			return false;
+		}
+		size_t sequence = m_MoveSequence.load(std::memory_order_relaxed);
+		m_MoveSequence.store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		m_MoveX.store(x, std::memory_order_relaxed);
+		m_MoveY.store(y, std::memory_order_relaxed);
+		m_MoveAt.store(tail, std::memory_order_relaxed);
+		m_MoveSequence.store(sequence + 2, std::memory_order_release);
+		return true;
+	}
+
+	m_Events[tail & (Capacity - 1)] = {type, x, y};
+	m_Tail.store(tail + 1, std::memory_order_release);
+	return true;
+}
+
+void InputQueue::drain(const std::function<void(const PointerEvent&)>& handler)
+{
+	size_t head = m_Head.load(std::memory_order_relaxed);
+	size_t tail = m_Tail.load(std::memory_order_acquire);
+
+	// Read after the tail: an overflow move pushed past it waits for the next drain.
+	size_t sequence;
+	PointerEvent overflow = {PointerEvent::Type::move, 0.0f, 0.0f};
+	size_t at;
+	do
+	{
+		sequence = m_MoveSequence.load(std::memory_order_acquire);
+		overflow.x = m_MoveX.load(std::memory_order_relaxed);
+		overflow.y = m_MoveY.load(std::memory_order_relaxed);
+		at = m_MoveAt.load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire);
+	} while ((sequence & 1) || sequence != m_MoveSequence.load(std::memory_order_relaxed));
+	bool hasOverflow = sequence != m_MoveTaken && at - head <= tail - head;
+
+	// A move followed by another move is stale by the time it would apply.
+	PointerEvent move;
+	bool hasMove = false;
+	auto deliver = [&](const PointerEvent& event) {
+		if (event.type == PointerEvent::Type::move)
+		{
+			move = event;
+			hasMove = true;
+			return;
+		}
+		if (hasMove && handler)
+		{
+			handler(move);
+		}
+		hasMove = false;
+		if (handler)
+		{
+			handler(event);
+		}
+	};
+	for (size_t i = head; i != tail; i++)
+	{
+		if (hasOverflow && i == at)
+		{
+			deliver(overflow);
+		}
+		deliver(m_Events[i & (Capacity - 1)]);
+	}
+	if (hasOverflow && at == tail)
+	{
+		deliver(overflow);
+	}
+	if (hasMove && handler)
+	{
+		handler(move);
+	}
+
+	if (hasOverflow)
+	{
+		m_MoveTaken = sequence;
+	}
+	m_Head.store(tail, std::memory_order_release);
+}
@@ -0,0 +1,404 @@
+#include <cstdio>
+#include <cstring>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "loaded_file.hpp"
+#include "file.hpp"
+#include "artboard.hpp"
+#include "component.hpp"
+#include "core/binary_reader.hpp"
+#include "animation/linear_animation.hpp"
+#include "animation/keyed_object.hpp"
+#include "animation/keyed_property.hpp"
+#include "animation/keyframe_double.hpp"
+
+using namespace rive_tizen;
+
+// Average heap of a runtime component (node, shape, path, paint and their
+// property storage). Components come in too many types to size each one
+// without RTTI, so this stays a rough figure for reporting.
+static const size_t ComponentBytes = 192;
+
+// Heap behind a string, none while it fits the inline buffer.
+static size_t stringBytes(const std::string& value)
+{
+	static const size_t InlineCapacity = std::string().capacity();
+	return value.capacity() > InlineCapacity ? value.capacity() + 1 : 0;
+}
+
+// Animation objects of a range, each with its slot in the owner's vector.
+// Color and id keyframes hold a value of the same size as double ones.
+static size_t animationBytes(const ArtboardRange& range)
+{
+	return range.animations * (sizeof(rive::LinearAnimation) + sizeof(void*)) +
+		range.keyedObjects * (sizeof(rive::KeyedObject) + sizeof(void*)) +
+		range.keyedProperties * (sizeof(rive::KeyedProperty) + sizeof(void*)) +
+		range.keyFrames * (sizeof(rive::KeyFrameDouble) + sizeof(void*));
+}
+
+// Keyed on the file's identity, files of the same name in different
+// directories, or reached through different paths, never share a cache.
+static std::string cachePath(const std::string& cacheDir, const char* fileName, const FileStamp& stamp)
+{
+	const char* name = strrchr(fileName, '/');
+	char identity[40];
+	snprintf(identity, sizeof(identity), ".%llx-%llx", static_cast<unsigned long long>(stamp.device),
+		static_cast<unsigned long long>(stamp.inode));
+	return cacheDir + "/" + (name ? name + 1 : fileName) + identity + ".rtzi";
+}
+
+namespace
+{
+	// Runs file jobs (imports and releases) in order on one thread, joined
+	// when the library is unloaded.
+	class FileWorker
+	{
+	public:
+		~FileWorker()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Stopping = true;
+			}
+			m_Wake.notify_one();
+			if (m_Thread.joinable())
+			{
+				m_Thread.join();
+			}
+		}
+
+		void push(std::function<void()> job)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_Mutex);
+				m_Jobs.push_back(std::move(job));
+				if (m_Thread.joinable() == false)
+				{
+					m_Thread = std::thread(&FileWorker::run, this);
+				}
+			}
+			m_Wake.notify_one();
+		}
+
+	private:
+		void run()
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			while (true)
+			{
+				m_Wake.wait(lock, [this]() { return m_Stopping || m_Jobs.empty() == false; });
+				// Jobs queued before shutdown still run, cancelled imports return at once.
+				if (m_Jobs.empty())
+				{
+					return;
+				}
+				auto job = std::move(m_Jobs.front());
+				m_Jobs.pop_front();
+				lock.unlock();
+				job();
+				job = nullptr;
+				lock.lock();
+			}
+		}
+
+		std::mutex m_Mutex;
+		std::condition_variable m_Wake;
+		std::deque<std::function<void()>> m_Jobs;
+		std::thread m_Thread;
+		bool m_Stopping = false;
+	};
+
+	FileWorker& worker()
+	{
+		// Constructed on first use, so destroyed before statics initialized earlier.
+		static FileWorker worker;
+		return worker;
+	}
+}
+
+void LoadedFile::release(std::shared_ptr<LoadedFile> file)
+{
+	worker().push([file]() mutable { file.reset(); });
+}
+
+void LoadedFile::post(std::function<void()> job)
+{
+	worker().push(std::move(job));
+}
+
+LoadedFile::LoadedFile() : m_Partial(-1), m_Lazy(false), m_Ready(0)
+{
+}
+
+LoadedFile::~LoadedFile()
+{
+}
+
+const uint8_t* LoadedFile::bytes() const
+{
+	return m_Source.data() ? m_Source.data() : m_Bytes.data();
+}
+
+bool LoadedFile::load(const char* fileName, bool lazy, const std::string& cacheDir,
+	const std::atomic<bool>* cancelled)
+{
+	auto stopped = [cancelled]() { return cancelled && cancelled->load(std::memory_order_acquire); };
+	if (stopped() || m_Source.open(fileName) == false)
+	{
+		return false;
+	}
+	m_Stamp = m_Source.stamp();
+	std::size_t length = m_Source.size();
+
+	// A valid cache spares reading the whole source just to index it.
+	std::string cache = cacheDir.empty() ? "" : cachePath(cacheDir, fileName, m_Stamp);
+	bool cached = cache.empty() == false && IndexCache::read(cache.c_str(), m_Stamp, m_Index);
+	if (cached == false)
+	{
+		// The index only walks the object stream, it's cheap next to a full import.
+		if (m_Index.scan(m_Source.data(), length) == false)
+		{
+			fprintf(stderr, "failed to index %s\n", fileName);
+			return false;
+		}
+		m_Index.finish(length);
+	}
+	// Nothing to draw, rejected in both modes like an empty stream.
+	if (m_Index.count() == 0)
+	{
+		fprintf(stderr, "no artboard in %s\n", fileName);
+		return false;
+	}
+	m_Lazy = lazy;
+	m_Path = fileName;
+	m_ArtboardFiles.resize(m_Index.count());
+
+	// Eager loads import every artboard now. Artboards are kept by position,
+	// names may repeat ("New Artboard").
+	size_t imports = m_Lazy ? 1 : m_ArtboardFiles.size();
+	for (size_t i = 0; i < imports; i++)
+	{
+		if (stopped())
+		{
+			return false;
+		}
+		if (artboardAt(i) == nullptr)
+		{
+			fprintf(stderr, "failed to import %s\n", fileName);
+			return false;
+		}
+	}
+
+	if (cache.empty() == false && cached == false &&
+		IndexCache::write(cache.c_str(), m_Stamp, m_Index) == false)
+	{
+		fprintf(stderr, "failed to write cache %s\n", cache.c_str());
+	}
+
+	if (m_Lazy == false)
+	{
+		// Everything is imported, instances map the source again if needed.
+		m_Source.close();
+	}
+	return true;
+}
+
+bool LoadedFile::mapSource()
+{
+	if (m_Source.open(m_Path.c_str()) == false)
+	{
+		return false;
+	}
+	// The ranges only hold for the bytes that were indexed.
+	if (m_Source.stamp() != m_Stamp || m_Source.size() != m_Index.at(m_Index.count() - 1).end)
+	{
+		fprintf(stderr, "%s changed since it was loaded\n", m_Path.c_str());
+		m_Source.close();
+		return false;
+	}
+	return true;
+}
+
+void LoadedFile::beginStream()
+{
+	m_Path.clear();
+	m_Source.close();
+	m_Bytes.clear();
+	m_Index.reset();
+	m_ArtboardFiles.clear();
+	m_Partial = -1;
+	m_PartialFiles.clear();
+	m_Lazy = true;
+	m_Ready = 0;
+}
+
+bool LoadedFile::append(const uint8_t* bytes, size_t length)
+{
+	m_Bytes.insert(m_Bytes.end(), bytes, bytes + length);
+
+	// The scan resumes where the previous chunk stopped.
+	if (m_Index.scan(m_Bytes.data(), m_Bytes.size()) == false)
+	{
+		return false;
+	}
+	m_ArtboardFiles.resize(m_Index.count());
+	size_t complete = m_Index.completeCount();
+
+	// The animations of the artboard drawn without them are all in.
+	if (m_Partial >= 0 && static_cast<size_t>(m_Partial) < complete)
+	{
+		m_PartialFiles.push_back(std::move(m_ArtboardFiles[m_Partial]));
+		if (artboardAt(m_Partial) == nullptr)
+		{
+			return false;
+		}
+		m_Partial = -1;
+	}
+	for (; m_Ready < complete; m_Ready++)
+	{
+		if (artboardAt(m_Ready) == nullptr)
+		{
+			return false;
+		}
+	}
+
+	// Components come before animations, the artboard can be drawn while
+	// its animations are still arriving.
+	if (m_Ready < m_Index.count() && m_Index.at(m_Ready).animationStart > 0)
+	{
+		m_ArtboardFiles[m_Ready].reset(m_Index.import(m_Bytes.data(), m_Ready, false));
+		if (m_ArtboardFiles[m_Ready] == nullptr)
+		{
+			return false;
+		}
+		m_Partial = static_cast<int>(m_Ready++);
+	}
+	return true;
+}
+
+rive::Artboard* LoadedFile::partialArtboard()
+{
+	return m_Partial >= 0 ? m_ArtboardFiles[m_Partial]->artboard() : nullptr;
+}
+
+bool LoadedFile::finishStream()
+{
+	if (m_Index.headerRead() == false || m_Index.scanned() != m_Bytes.size())
+	{
+		// Truncated header or object.
+		return false;
+	}
+	m_Index.finish(m_Bytes.size());
+	return append(nullptr, 0) && m_Ready > 0;
+}
+
+size_t LoadedFile::artboardCount() const
+{
+	return m_Index.count();
+}
+
+int LoadedFile::find(const char* name) const
+{
+	return m_Index.find(name);
+}
+
+rive::Artboard* LoadedFile::artboard(const char* name)
+{
+	int index = find(name);
+	if (index < 0)
+	{
+		return nullptr;
+	}
+	return artboardAt(index);
+}
+
+rive::Artboard* LoadedFile::artboardAt(size_t index)
+{
+	if (index >= artboardCount())
+	{
+		return nullptr;
+	}
+	if (m_ArtboardFiles[index] == nullptr)
+	{
+		m_ArtboardFiles[index].reset(m_Index.import(bytes(), index));
+		if (m_ArtboardFiles[index] == nullptr)
+		{
+			return nullptr;
+		}
+	}
+	return m_ArtboardFiles[index]->artboard();
+}
+
+rive::File* LoadedFile::importInstance(size_t index, size_t& importedBytes)
+{
+	importedBytes = 0;
+	if (artboardAt(index) == nullptr)
+	{
+		return nullptr;
+	}
+	// Eager loads let go of the source, the first instance brings it back.
+	if (bytes() == nullptr && mapSource() == false)
+	{
+		return nullptr;
+	}
+
+	auto& range = m_Index.at(index);
+	size_t end = range.animationStart > 0 ? range.animationStart : range.end;
+	importedBytes = m_Index.at(0).start + end - range.start;
+	return m_Index.import(bytes(), index, false);
+}
+
+void LoadedFile::artboardUsage(rive::Artboard* artboard, size_t& objects, size_t& strings)
+{
+	objects += artboard->objects().size() * ComponentBytes;
+	for (auto object : artboard->objects())
+	{
+		if (object && object->is<rive::Component>())
+		{
+			strings += stringBytes(object->as<rive::Component>()->name());
+		}
+	}
+}
+
+void LoadedFile::usage(size_t& objects, size_t& animations, size_t& strings)
+{
+	objects = 0;
+	animations = 0;
+	strings = 0;
+	for (size_t i = 0; i < artboardCount(); i++)
+	{
+		auto& range = m_Index.at(i);
+		strings += stringBytes(range.name);
+
+		// Only what has been imported, without importing the rest.
+		rive::Artboard* artboard = nullptr;
+		if (i < m_ArtboardFiles.size() && m_ArtboardFiles[i])
+		{
+			artboard = m_ArtboardFiles[i]->artboard();
+		}
+		if (artboard == nullptr)
+		{
+			continue;
+		}
+
+		artboardUsage(artboard, objects, strings);
+		// A streamed artboard drawn before its animations has none yet.
+		if (static_cast<int>(i) == m_Partial)
+		{
+			continue;
+		}
+		animations += animationBytes(range);
+		for (size_t j = 0; j < artboard->animationCount(); j++)
+		{
+			strings += stringBytes(artboard->animation(j)->name());
+		}
+	}
+	for (auto& file : m_PartialFiles)
+	{
+		artboardUsage(file->artboard(), objects, strings);
+	}
+}
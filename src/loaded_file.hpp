@@ -0,0 +1,103 @@
+#ifndef _RIVE_TIZEN_LOADED_FILE_HPP_
+#define _RIVE_TIZEN_LOADED_FILE_HPP_
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "artboard_index.hpp"
+#include "index_cache.hpp"
+#include "mapped_file.hpp"
+
+namespace rive
+{
+	class Artboard;
+	class File;
+}
+
+namespace rive_tizen
+{
+	// Everything imported from one .riv file. Loading touches nothing else, so
+	// a LoadedFile can be built on a worker thread and handed to a Controller.
+	class LoadedFile
+	{
+	public:
+		LoadedFile();
+		~LoadedFile();
+
+		// With lazy set, only the artboard byte ranges are indexed and each
+		// artboard is imported the first time it is requested. A non empty
+		// cacheDir enables the index cache. Once cancelled is set the load
+		// gives up before the next artboard import.
+		bool load(const char* fileName, bool lazy, const std::string& cacheDir,
+			const std::atomic<bool>* cancelled = nullptr);
+
+		// Streaming: the file arrives in chunks through append(). An artboard
+		// is imported without its animations as soon as they start, and again
+		// with them once its byte range is complete, that is when the next
+		// artboard starts or at finishStream().
+		void beginStream();
+		// Returns false on malformed data.
+		bool append(const uint8_t* bytes, size_t length);
+		bool finishStream();
+		// Number of leading artboards imported so far, with or without animations.
+		size_t readyCount() const { return m_Ready; }
+		// The artboard imported without its animations, nullptr when none.
+		// Once they arrive artboardAt() returns another import and this one
+		// stays alive for the pointers taken from it.
+		rive::Artboard* partialArtboard();
+		int partialIndex() const { return m_Partial; }
+
+		size_t artboardCount() const;
+		// Returns the artboard index or -1.
+		int find(const char* name) const;
+		rive::Artboard* artboard(const char* name);
+		rive::Artboard* artboardAt(size_t index);
+		// Imports another copy of an artboard for an instance, the caller owns
+		// the file. Animations are left out when the source bytes are at hand,
+		// the instance borrows them from artboardAt(index).
+		rive::File* importInstance(size_t index, size_t& importedBytes);
+
+		// Bytes kept for importing: the mapped source or the streamed bytes.
+		size_t retainedBytes() const { return m_Bytes.capacity() + m_Source.size(); }
+		// Heap of the artboards imported so far: their runtime components
+		// (estimated), their animations (counted by the index scan, sized by
+		// type) and the names of both (measured).
+		void usage(size_t& objects, size_t& animations, size_t& strings);
+		// Adds the estimated heap of the runtime components of an artboard
+		// and the measured heap of their names.
+		static void artboardUsage(rive::Artboard* artboard, size_t& objects, size_t& strings);
+
+		// Drops a reference on a worker owned by the library, tearing down a
+		// large file takes as long as importing it. The worker is drained and
+		// joined at exit, the renderer's geometry pool is never destroyed.
+		static void release(std::shared_ptr<LoadedFile> file);
+		// Runs job on the same worker, after the jobs posted before it.
+		static void post(std::function<void()> job);
+
+	private:
+		bool mapSource();
+		const uint8_t* bytes() const;
+
+		// Source file, empty for streams. Eager loads unmap it once
+		// everything is imported.
+		std::string m_Path;
+		MappedFile m_Source;
+		FileStamp m_Stamp;
+		// Streamed bytes.
+		std::vector<uint8_t> m_Bytes;
+		ArtboardIndex m_Index;
+		// One single-artboard file per index, imported on demand in lazy mode.
+		std::vector<std::unique_ptr<rive::File>> m_ArtboardFiles;
+		// Streams: index of the artboard imported without animations or -1,
+		// and the components only imports replaced since.
+		int m_Partial;
+		std::vector<std::unique_ptr<rive::File>> m_PartialFiles;
+		bool m_Lazy;
+		size_t m_Ready;
+	};
+}
+
+#endif
@@ -0,0 +1,94 @@
+#include <cstdio>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "mapped_file.hpp"
+
+using namespace rive_tizen;
+
+MappedFile::MappedFile() : m_Data(nullptr), m_Size(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
+
+bool MappedFile::open(const char* path)
+{
+	close();
+
+#ifndef _WIN32
+	int fd = ::open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		return false;
+	}
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size <= 0)
+	{
+		::close(fd);
+		return false;
+	}
+	void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (data == MAP_FAILED)
+	{
+		return false;
+	}
+	m_Data = static_cast<const uint8_t*>(data);
+	m_Size = info.st_size;
+	m_Stamp.size = info.st_size;
+	m_Stamp.modifiedSeconds = info.st_mtim.tv_sec;
+	m_Stamp.modifiedNanoseconds = info.st_mtim.tv_nsec;
+	m_Stamp.inode = info.st_ino;
+	m_Stamp.device = info.st_dev;
+#else
+	FILE* fp = fopen(path, "rb");
+	if (fp == nullptr)
+	{
+		return false;
+	}
+	fseek(fp, 0, SEEK_END);
+	long size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	if (size <= 0)
+	{
+		fclose(fp);
+		return false;
+	}
+	auto data = new uint8_t[size];
+	if (fread(data, 1, size, fp) != static_cast<size_t>(size))
+	{
+		delete[] data;
+		fclose(fp);
+		return false;
+	}
+	fclose(fp);
+	m_Data = data;
+	m_Size = size;
+	m_Stamp = FileStamp();
+#endif
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (m_Data == nullptr)
+	{
+		return;
+	}
+#ifndef _WIN32
+	munmap(const_cast<uint8_t*>(m_Data), m_Size);
+#else
+	delete[] m_Data;
+#endif
+	m_Data = nullptr;
+	m_Size = 0;
+	m_Stamp = FileStamp();
+}
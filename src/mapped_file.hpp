@@ -0,0 +1,53 @@
+#ifndef _RIVE_TIZEN_MAPPED_FILE_HPP_
+#define _RIVE_TIZEN_MAPPED_FILE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace rive_tizen
+{
+	// Identity of a file's content as far as the file system tells: equal
+	// stamps mean the file wasn't replaced or written in between.
+	struct FileStamp
+	{
+		uint64_t size = 0;
+		uint64_t modifiedSeconds = 0;
+		uint64_t modifiedNanoseconds = 0;
+		uint64_t inode = 0;
+		uint64_t device = 0;
+
+		bool operator==(const FileStamp& other) const
+		{
+			return size == other.size && modifiedSeconds == other.modifiedSeconds &&
+				modifiedNanoseconds == other.modifiedNanoseconds && inode == other.inode &&
+				device == other.device;
+		}
+		bool operator!=(const FileStamp& other) const { return !(*this == other); }
+	};
+
+	// Read only view of a whole file. Mapped where the platform allows, so
+	// pages are only read once touched and stay reclaimable by the kernel.
+	class MappedFile
+	{
+	public:
+		MappedFile();
+		~MappedFile();
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool open(const char* path);
+		void close();
+
+		const uint8_t* data() const { return m_Data; }
+		size_t size() const { return m_Size; }
+		// Stamp taken when the file was opened, zero when the platform has none.
+		const FileStamp& stamp() const { return m_Stamp; }
+
+	private:
+		const uint8_t* m_Data;
+		size_t m_Size;
+		FileStamp m_Stamp;
+	};
+}
+
+#endif
@@ -0,0 +1,51 @@
+#include "rive_tizen.hpp"
+
+using namespace rive_tizen;
+
+void PropertyBatch::queue(const Write& write)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+
+	auto slot = m_Slots.emplace(SlotKey(write.component, write.setter), m_Writes.size());
+	if (slot.second)
+	{
+		m_Writes.push_back(write);
+	}
+	else
+	{
+		m_Writes[slot.first->second] = write;
+	}
+}
+
+void PropertyBatch::apply()
+{
+	{
+		// Writers only wait for the swap, not for the properties to be set.
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Applying.swap(m_Writes);
+		m_Slots.clear();
+	}
+
+	for (auto& write : m_Applying)
+	{
+		if (write.index->generation() != write.generation)
+		{
+			continue;
+		}
+		write.apply(write);
+	}
+	m_Applying.clear();
+}
+
+void PropertyBatch::clear()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Writes.clear();
+	m_Slots.clear();
+}
+
+size_t PropertyBatch::size()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Writes.size();
+}
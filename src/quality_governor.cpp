@@ -0,0 +1,91 @@
+#include <algorithm>
+
+#include "rive_tizen.hpp"
+
+using namespace rive_tizen;
+
+// Slow frames before stepping down, short enough to react within a fraction
+// of a second. Only frames over budget themselves count, the average alone
+// stays high for a while after a single hitch.
+static const int StepDownFrames = 8;
+// Frames in a row with headroom before stepping back up, longer than the
+// step down so the tiers don't oscillate.
+static const int StepUpFrames = 90;
+// Share of the budget the average must fall under to count as headroom.
+static const double Headroom = 0.7;
+// Samples are clamped to this many budgets, so that a hitch doesn't hold
+// the average up, and the headroom off, for dozens of frames.
+static const double MaxSampleBudgets = 2.0;
+static const size_t MaxHistory = 64;
+
+QualityGovernor::QualityGovernor() : m_Budget(0), m_Average(0), m_Tier(0), m_Over(0), m_Under(0), m_Frame(0)
+{
+}
+
+void QualityGovernor::budget(double milliseconds)
+{
+	m_Budget = milliseconds > 0 ? milliseconds : 0;
+	m_Average = 0;
+	m_Over = 0;
+	m_Under = 0;
+	if (m_Budget == 0 && m_Tier != 0)
+	{
+		change(0);
+	}
+}
+
+bool QualityGovernor::sample(double milliseconds)
+{
+	m_Frame++;
+	if (m_Budget == 0)
+	{
+		return false;
+	}
+
+	// Exponential moving average, about the last ten frames.
+	double cost = std::min(milliseconds, m_Budget * MaxSampleBudgets);
+	m_Average = m_Average == 0 ? cost : m_Average * 0.9 + cost * 0.1;
+
+	if (m_Average > m_Budget)
+	{
+		m_Under = 0;
+		// Counted while the average stays over, a fast frame in between
+		// doesn't start over so uneven loads still step down.
+		if (milliseconds > m_Budget && ++m_Over >= StepDownFrames && m_Tier < MaxTier)
+		{
+			change(m_Tier + 1);
+			return true;
+		}
+	}
+	else if (m_Average < m_Budget * Headroom)
+	{
+		m_Over = 0;
+		if (++m_Under >= StepUpFrames && m_Tier > 0)
+		{
+			change(m_Tier - 1);
+			return true;
+		}
+	}
+	else
+	{
+		m_Over = 0;
+		m_Under = 0;
+	}
+	return false;
+}
+
+void QualityGovernor::change(int tier)
+{
+	m_Tier = tier;
+	m_Over = 0;
+	m_Under = 0;
+
+	if (m_History.size() == MaxHistory)
+	{
+		m_History.erase(m_History.begin());
+	}
+	m_History.push_back({m_Frame, tier, m_Average});
+	// The average still holds the frames of the previous tier, judge the new
+	// one on its own frames or it steps again before its cost shows.
+	m_Average = 0;
+}
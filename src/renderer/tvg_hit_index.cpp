@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include "tvg_hit_index.hpp"
+#include "tvg_renderer.hpp"
+
+using namespace rive;
+
+//Straight segments per cubic, plenty for pointer sized targets.
+static const int CubicSegments = 16;
+//Refitted trees get looser as things move, rebuild them now and then.
+static const int MaxRefits = 120;
+static const int LeafSize = 4;
+
+static void unite(float* a, const float* b)
+{
+   a[0] = fminf(a[0], b[0]);
+   a[1] = fminf(a[1], b[1]);
+   a[2] = fmaxf(a[2], b[2]);
+   a[3] = fmaxf(a[3], b[3]);
+}
+
+static bool inside(const float* bounds, float x, float y)
+{
+   return x >= bounds[0] && x <= bounds[2] && y >= bounds[1] && y <= bounds[3];
+}
+
+void TvgHitIndex::clear()
+{
+   m_Nodes.clear();
+   m_Items.clear();
+   m_Paths.clear();
+   m_Refits = 0;
+}
+
+void TvgHitIndex::update(const vector<TvgHitRecord>& records)
+{
+   bool same = !m_Nodes.empty() && m_Refits < MaxRefits && m_Paths.size() == records.size();
+   for (size_t i = 0; same && i < records.size(); ++i)
+   {
+      same = m_Paths[i] == records[i].path;
+   }
+
+   if (same)
+   {
+      refit(records);
+      ++m_Refits;
+      return;
+   }
+
+   clear();
+   if (records.empty()) return;
+
+   m_Paths.reserve(records.size());
+   m_Items.reserve(records.size());
+   for (size_t i = 0; i < records.size(); ++i)
+   {
+      m_Paths.push_back(records[i].path);
+      m_Items.push_back(static_cast<int>(i));
+   }
+   m_Nodes.reserve(2 * records.size() / LeafSize + 1);
+   //The root is the first node build() adds.
+   build(records, 0, static_cast<int>(records.size()));
+}
+
+int TvgHitIndex::build(const vector<TvgHitRecord>& records, int first, int count)
+{
+   int node = static_cast<int>(m_Nodes.size());
+   m_Nodes.emplace_back();
+
+   float bounds[4] = {FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX};
+   int maxOrder = -1;
+   for (int i = first; i < first + count; ++i)
+   {
+      unite(bounds, records[m_Items[i]].bounds);
+      maxOrder = max(maxOrder, m_Items[i]);
+   }
+   memcpy(m_Nodes[node].bounds, bounds, sizeof(bounds));
+   m_Nodes[node].maxOrder = maxOrder;
+   m_Nodes[node].left = m_Nodes[node].right = -1;
+   m_Nodes[node].first = first;
+   m_Nodes[node].count = count;
+
+   if (count <= LeafSize) return node;
+
+   //Median split along the longer axis of the node.
+   int axis = (bounds[2] - bounds[0]) >= (bounds[3] - bounds[1]) ? 0 : 1;
+   int half = count / 2;
+   nth_element(m_Items.begin() + first, m_Items.begin() + first + half, m_Items.begin() + first + count,
+               [&records, axis](int a, int b) {
+                  return records[a].bounds[axis] + records[a].bounds[axis + 2] <
+                         records[b].bounds[axis] + records[b].bounds[axis + 2];
+               });
+
+   //m_Nodes may grow while building the children, don't hold references.
+   int left = build(records, first, half);
+   int right = build(records, first + half, count - half);
+   m_Nodes[node].left = left;
+   m_Nodes[node].right = right;
+   m_Nodes[node].count = 0;
+   return node;
+}
+
+void TvgHitIndex::refit(const vector<TvgHitRecord>& records)
+{
+   //Children come after their parent, so walking backwards refits bottom up.
+   for (auto node = m_Nodes.rbegin(); node != m_Nodes.rend(); ++node)
+   {
+      if (node->count > 0)
+      {
+         memcpy(node->bounds, records[m_Items[node->first]].bounds, sizeof(node->bounds));
+         for (int i = node->first + 1; i < node->first + node->count; ++i)
+         {
+            unite(node->bounds, records[m_Items[i]].bounds);
+         }
+      }
+      else
+      {
+         memcpy(node->bounds, m_Nodes[node->left].bounds, sizeof(node->bounds));
+         unite(node->bounds, m_Nodes[node->right].bounds);
+      }
+   }
+}
+
+int TvgHitIndex::query(const vector<TvgHitRecord>& records, float x, float y) const
+{
+   if (m_Nodes.empty()) return -1;
+
+   //Median splits keep the depth at log2(n), the stack can't overflow.
+   int stack[128];
+   int top = 0;
+   stack[top++] = 0;
+   int best = -1;
+
+   while (top > 0)
+   {
+      auto& node = m_Nodes[stack[--top]];
+      if (node.maxOrder <= best || !inside(node.bounds, x, y)) continue;
+
+      if (node.count > 0)
+      {
+         for (int i = node.first; i < node.first + node.count; ++i)
+         {
+            int order = m_Items[i];
+            if (order > best && inside(records[order].bounds, x, y) && hitPath(records[order], x, y))
+               best = order;
+         }
+         continue;
+      }
+
+      //Visit the child holding later draws first, it prunes the other one more often.
+      auto& left = m_Nodes[node.left];
+      auto& right = m_Nodes[node.right];
+      if (left.maxOrder > right.maxOrder)
+      {
+         stack[top++] = node.right;
+         stack[top++] = node.left;
+      }
+      else
+      {
+         stack[top++] = node.left;
+         stack[top++] = node.right;
+      }
+   }
+   return best;
+}
+
+//Calls segment(a, b) for every straight piece of the path, curves flattened.
+//Open sub paths are closed when closeAll is set, as fills do.
+template<typename Segment>
+static void forEachSegment(const Shape* shape, bool closeAll, Segment segment)
+{
+   const PathCommand* cmds;
+   auto cmdCnt = shape->pathCommands(&cmds);
+   const Point* pts;
+   auto ptsCnt = shape->pathCoords(&pts);
+   if (!cmds || !pts) return;
+
+   Point start = {0, 0};
+   Point last = {0, 0};
+   bool open = false;
+   unsigned p = 0;
+   for (unsigned i = 0; i < cmdCnt; ++i)
+   {
+      switch (cmds[i])
+      {
+         case PathCommand::MoveTo:
+            if (p + 1 > ptsCnt) return;
+            if (open && closeAll) segment(last, start);
+            start = last = pts[p++];
+            open = true;
+            break;
+         case PathCommand::LineTo:
+            if (p + 1 > ptsCnt) return;
+            segment(last, pts[p]);
+            last = pts[p++];
+            break;
+         case PathCommand::CubicTo:
+         {
+            if (p + 3 > ptsCnt) return;
+            auto& c1 = pts[p];
+            auto& c2 = pts[p + 1];
+            auto& end = pts[p + 2];
+            auto prev = last;
+            for (int s = 1; s <= CubicSegments; ++s)
+            {
+               float t = static_cast<float>(s) / CubicSegments;
+               float u = 1.0f - t;
+               float a = u * u * u, b = 3 * u * u * t, c = 3 * u * t * t, d = t * t * t;
+               Point pt = {a * last.x + b * c1.x + c * c2.x + d * end.x,
+                           a * last.y + b * c1.y + c * c2.y + d * end.y};
+               segment(prev, pt);
+               prev = pt;
+            }
+            last = end;
+            p += 3;
+            break;
+         }
+         case PathCommand::Close:
+            segment(last, start);
+            last = start;
+            open = false;
+            break;
+      }
+   }
+   if (open && closeAll) segment(last, start);
+}
+
+bool rive::hitPath(const TvgHitRecord& record, float x, float y)
+{
+   auto shape = record.geometry->shape.get();
+
+   //Back to path space, where the geometry lives.
+   auto& m = record.transform;
+   float det = m.e11 * m.e22 - m.e12 * m.e21;
+   if (fabsf(det) < 1e-12f) return false;
+   float dx = x - m.e13;
+   float dy = y - m.e23;
+   Point pt = {(m.e22 * dx - m.e12 * dy) / det, (m.e11 * dy - m.e21 * dx) / det};
+
+   if (record.thickness > 0.0f)
+   {
+      float reach = record.thickness * 0.5f;
+      float reach2 = reach * reach;
+      bool hit = false;
+      forEachSegment(shape, false, [&](const Point& a, const Point& b) {
+         if (hit) return;
+         float ex = b.x - a.x, ey = b.y - a.y;
+         float len2 = ex * ex + ey * ey;
+         float t = len2 > 0.0f ? ((pt.x - a.x) * ex + (pt.y - a.y) * ey) / len2 : 0.0f;
+         t = fminf(fmaxf(t, 0.0f), 1.0f);
+         float cx = a.x + t * ex - pt.x, cy = a.y + t * ey - pt.y;
+         hit = cx * cx + cy * cy <= reach2;
+      });
+      return hit;
+   }
+
+   int winding = 0;
+   forEachSegment(shape, true, [&](const Point& a, const Point& b) {
+      float side = (b.x - a.x) * (pt.y - a.y) - (pt.x - a.x) * (b.y - a.y);
+      if (a.y <= pt.y && b.y > pt.y && side > 0) ++winding;
+      else if (b.y <= pt.y && a.y > pt.y && side < 0) --winding;
+   });
+   if (shape->fillRule() == tvg::FillRule::EvenOdd) return (winding & 1) != 0;
+   return winding != 0;
+}
@@ -0,0 +1,67 @@
+#ifndef _RIVE_THORVG_HIT_INDEX_HPP_
+#define _RIVE_THORVG_HIT_INDEX_HPP_
+
+#include <thorvg.h>
+#include <memory>
+#include <vector>
+
+using namespace tvg;
+using namespace std;
+
+namespace rive
+{
+   class RenderPath;
+   struct TvgGeometry;
+
+   //A draw of the last frame, as seen by pointer input.
+   struct TvgHitRecord
+   {
+      const RenderPath* path;
+      shared_ptr<TvgGeometry> geometry;
+      Matrix transform;
+      //Canvas space {minX, minY, maxX, maxY}, narrowed by the clip bounds.
+      float bounds[4];
+      //Zero for fills.
+      float thickness;
+   };
+
+   //Bounding volume hierarchy over the draws of a frame. When a frame draws
+   //the same paths in the same order as the one the tree was built for, only
+   //the node bounds are refitted; any other change rebuilds it.
+   class TvgHitIndex
+   {
+   private:
+      struct Node
+      {
+         float bounds[4];
+         //Highest draw order below this node, lets queries skip subtrees
+         //that can't beat the topmost hit found so far.
+         int maxOrder;
+         //Inner nodes only, children always come after their parent.
+         int left;
+         int right;
+         //Leaf nodes only: items [first, first + count).
+         int first;
+         int count;
+      };
+
+      vector<Node> m_Nodes;
+      vector<int> m_Items;
+      vector<const RenderPath*> m_Paths;
+      int m_Refits = 0;
+
+      int build(const vector<TvgHitRecord>& records, int first, int count);
+      void refit(const vector<TvgHitRecord>& records);
+
+   public:
+      void update(const vector<TvgHitRecord>& records);
+      void clear();
+      //Index of the topmost record whose path covers the point, -1 for none.
+      int query(const vector<TvgHitRecord>& records, float x, float y) const;
+   };
+
+   //Exact test of a canvas space point against the filled or stroked path.
+   bool hitPath(const TvgHitRecord& record, float x, float y);
+}
+
+#endif
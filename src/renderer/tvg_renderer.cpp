@@ -1,21 +1,152 @@
+#include <cfloat>
+#include <cmath>
+#include <cstring>
 #include "tvg_renderer.hpp"
 #include "math/vec2d.hpp"
 #include "shapes/paint/color.hpp"
 
 using namespace rive;
 
+atomic<uint32_t> TvgRenderPaint::s_NextId(0);
+atomic<uint32_t> TvgRenderer::s_NextTransformVersion(0);
+atomic<uint32_t> TvgRenderer::s_NextFrameId(0);
+atomic<size_t> TvgMemory::shapes(0);
+atomic<size_t> TvgMemory::fills(0);
+atomic<size_t> TvgGeometryPool::s_NextSerial(0);
+
+static size_t hashBytes(size_t hash, const void* data, size_t size)
+{
+   //FNV-1a
+   auto bytes = static_cast<const uint8_t*>(data);
+   for (size_t i = 0; i < size; ++i)
+   {
+      hash ^= bytes[i];
+      hash *= 1099511628211ULL;
+   }
+   return hash;
+}
+
+//Rough size of thorvg's private data behind a shape and a gradient.
+static const size_t ShapeOverhead = 256;
+static const size_t FillOverhead = 96;
+
+size_t TvgMemory::shapeBytes(const Shape* shape)
+{
+   const PathCommand* cmds;
+   const Point* pts;
+   return ShapeOverhead + shape->pathCommands(&cmds) * sizeof(PathCommand) + shape->pathCoords(&pts) * sizeof(Point);
+}
+
+size_t TvgMemory::fillBytes(const tvg::Fill* fill)
+{
+   const tvg::Fill::ColorStop* stops;
+   return FillOverhead + fill->colorStops(&stops) * sizeof(tvg::Fill::ColorStop);
+}
+
+static bool sameGeometry(const Shape* a, const Shape* b)
+{
+   const PathCommand *cmdsA, *cmdsB;
+   const Point *ptsA, *ptsB;
+   auto cmdCnt = a->pathCommands(&cmdsA);
+   auto ptsCnt = a->pathCoords(&ptsA);
+   if (cmdCnt != b->pathCommands(&cmdsB) || ptsCnt != b->pathCoords(&ptsB)) return false;
+   if (a->fillRule() != b->fillRule()) return false;
+   if (cmdCnt > 0 && memcmp(cmdsA, cmdsB, sizeof(PathCommand) * cmdCnt)) return false;
+   if (ptsCnt > 0 && memcmp(ptsA, ptsB, sizeof(Point) * ptsCnt)) return false;
+   return true;
+}
+
+TvgGeometryPool& TvgGeometryPool::instance()
+{
+   static auto pool = new TvgGeometryPool;
+   return *pool;
+}
+
+shared_ptr<TvgGeometry> TvgGeometryPool::intern(unique_ptr<Shape> shape)
+{
+   const PathCommand* cmds;
+   const Point* pts;
+   auto cmdCnt = shape->pathCommands(&cmds);
+   auto ptsCnt = shape->pathCoords(&pts);
+   auto rule = shape->fillRule();
+
+   size_t hash = 14695981039346656037ULL;
+   hash = hashBytes(hash, &rule, sizeof(rule));
+   if (cmdCnt > 0) hash = hashBytes(hash, cmds, sizeof(PathCommand) * cmdCnt);
+   if (ptsCnt > 0) hash = hashBytes(hash, pts, sizeof(Point) * ptsCnt);
+
+   auto& pool = instance();
+   lock_guard<mutex> lock(pool.m_Mutex);
+
+   auto range = pool.m_Geometries.equal_range(hash);
+   for (auto it = range.first; it != range.second; ++it)
+   {
+      if (!sameGeometry(it->second->shape.get(), shape.get())) continue;
+      //The entry stays registered until its last owner lets go.
+      auto shared = it->second->self.lock();
+      if (shared) return shared;
+   }
+
+   TvgMemory::shapes += TvgMemory::shapeBytes(shape.get());
+   auto geometry = new TvgGeometry;
+   geometry->shape = move(shape);
+   geometry->hash = hash;
+   geometry->pooled = true;
+   auto shared = shared_ptr<TvgGeometry>(geometry, release);
+   geometry->self = shared;
+   pool.m_Geometries.emplace(hash, geometry);
+   return shared;
+}
+
+shared_ptr<TvgGeometry> TvgGeometryPool::adopt(unique_ptr<Shape> shape)
+{
+   TvgMemory::shapes += TvgMemory::shapeBytes(shape.get());
+   auto geometry = new TvgGeometry;
+   geometry->shape = move(shape);
+   //Signatures only need to tell geometries apart, see TvgRenderer::drawSignature().
+   geometry->hash = ++s_NextSerial;
+   return shared_ptr<TvgGeometry>(geometry, discard);
+}
+
+void TvgGeometryPool::release(TvgGeometry* geometry)
+{
+   {
+      auto& pool = instance();
+      lock_guard<mutex> lock(pool.m_Mutex);
+      auto range = pool.m_Geometries.equal_range(geometry->hash);
+      for (auto it = range.first; it != range.second; ++it)
+      {
+         if (it->second == geometry)
+         {
+            pool.m_Geometries.erase(it);
+            break;
+         }
+      }
+   }
+   discard(geometry);
+}
+
+void TvgGeometryPool::discard(TvgGeometry* geometry)
+{
+   TvgMemory::shapes -= TvgMemory::shapeBytes(geometry->shape.get());
+   delete geometry;
+}
+
 
 void TvgRenderPath::fillRule(FillRule value)
 {
+   auto previous = rule;
    switch (value)
    {
       case FillRule::evenOdd:
-         tvgShape->fill(tvg::FillRule::EvenOdd);
+         rule = tvg::FillRule::EvenOdd;
          break;
       case FillRule::nonZero:
-         tvgShape->fill(tvg::FillRule::Winding);
+         rule = tvg::FillRule::Winding;
          break;
    }
+   //Fills set their rule on every draw, only a change needs a new geometry.
+   if (rule != previous) dirty = true;
 }
 
 Point transformCoord(const Point pt, const Mat2D &transform)
@@ -31,30 +162,261 @@ Point transformCoord(const Point pt, const Mat2D &transform)
    return {pt.x * m.e11 + pt.y * m.e12 + m.e13, pt.x * m.e21 + pt.y * m.e22 + m.e23};
 }
 
+//Bounds are kept as {minX, minY, maxX, maxY} in canvas space.
+static bool overlaps(const float* a, const float* b)
+{
+   return a[0] < b[2] && b[0] < a[2] && a[1] < b[3] && b[1] < a[3];
+}
+
+static bool contains(const float* outer, const float* inner)
+{
+   return outer[0] <= inner[0] && outer[1] <= inner[1] && outer[2] >= inner[2] && outer[3] >= inner[3];
+}
+
+//Canvas space bounds of the path points. Curve control points are included,
+//so the result is conservative.
+static bool pathBounds(const Shape* shape, const Mat2D& transform, float* bounds)
+{
+   const Point* pts;
+   auto ptsCnt = shape->pathCoords(&pts);
+   if (!pts || ptsCnt == 0) return false;
+
+   bounds[0] = bounds[1] = FLT_MAX;
+   bounds[2] = bounds[3] = -FLT_MAX;
+   for (unsigned i = 0; i < ptsCnt; ++i)
+   {
+      auto pt = transformCoord(pts[i], transform);
+      if (pt.x < bounds[0]) bounds[0] = pt.x;
+      if (pt.y < bounds[1]) bounds[1] = pt.y;
+      if (pt.x > bounds[2]) bounds[2] = pt.x;
+      if (pt.y > bounds[3]) bounds[3] = pt.y;
+   }
+   return true;
+}
+
+//Canvas space bounds of what a draw can touch, stroke extent included.
+static bool drawBounds(const Shape* shape, const TvgPaint* paint, const Mat2D& transform, float* bounds)
+{
+   if (!pathBounds(shape, transform, bounds)) return false;
+   if (paint->style != RenderPaintStyle::stroke) return true;
+
+   float scaleX = sqrt(transform[0] * transform[0] + transform[1] * transform[1]);
+   float scaleY = sqrt(transform[2] * transform[2] + transform[3] * transform[3]);
+   //Miter joins may reach the (default 4) miter limit, square caps the half diagonal.
+   float reach = (paint->join == tvg::StrokeJoin::Miter) ? 4.0f : 1.5f;
+   float extent = paint->thickness * 0.5f * reach * (scaleX > scaleY ? scaleX : scaleY);
+   bounds[0] -= extent;
+   bounds[1] -= extent;
+   bounds[2] += extent;
+   bounds[3] += extent;
+   return true;
+}
+
+//True if the path is a single axis aligned rectangle in canvas space.
+static bool pathRect(const Shape* shape, const Mat2D& transform, float* rect)
+{
+   const PathCommand* cmds;
+   auto cmdCnt = shape->pathCommands(&cmds);
+   const Point* pts;
+   auto ptsCnt = shape->pathCoords(&pts);
+   if (!cmds || !pts) return false;
+
+   //MoveTo + 3 LineTo, optionally a LineTo back to the start, optionally closed.
+   if ((ptsCnt != 4 && ptsCnt != 5) || cmdCnt < ptsCnt) return false;
+   if (cmds[0] != PathCommand::MoveTo) return false;
+   for (unsigned i = 1; i < ptsCnt; ++i)
+   {
+      if (cmds[i] != PathCommand::LineTo) return false;
+   }
+   if (cmdCnt > ptsCnt + 1 || (cmdCnt == ptsCnt + 1 && cmds[ptsCnt] != PathCommand::Close)) return false;
+
+   Point corners[5];
+   for (unsigned i = 0; i < ptsCnt; ++i) corners[i] = transformCoord(pts[i], transform);
+   if (ptsCnt == 5 && (fabsf(corners[4].x - corners[0].x) > 1e-3f || fabsf(corners[4].y - corners[0].y) > 1e-3f)) return false;
+
+   //Every edge must be either horizontal or vertical, alternating.
+   bool horizontal = fabsf(corners[1].y - corners[0].y) <= 1e-3f;
+   for (unsigned i = 0; i < 4; ++i)
+   {
+      auto& a = corners[i];
+      auto& b = corners[(i + 1) % 4];
+      bool edgeHorizontal = ((i % 2) == 0) == horizontal;
+      if (edgeHorizontal && fabsf(b.y - a.y) > 1e-3f) return false;
+      if (!edgeHorizontal && fabsf(b.x - a.x) > 1e-3f) return false;
+   }
+
+   rect[0] = fminf(corners[0].x, corners[2].x);
+   rect[1] = fminf(corners[0].y, corners[2].y);
+   rect[2] = fmaxf(corners[0].x, corners[2].x);
+   rect[3] = fmaxf(corners[0].y, corners[2].y);
+   return true;
+}
+
+static void intersect(float* a, const float* b)
+{
+   a[0] = fmaxf(a[0], b[0]);
+   a[1] = fmaxf(a[1], b[1]);
+   a[2] = fminf(a[2], b[2]);
+   a[3] = fminf(a[3], b[3]);
+}
+
+static Matrix toMatrix(const Mat2D& transform)
+{
+   return {transform[0], transform[2], transform[4], transform[1], transform[3], transform[5], 0, 0, 1};
+}
+
+static bool sameMatrix(const Matrix& a, const Matrix& b)
+{
+   return a.e11 == b.e11 && a.e12 == b.e12 && a.e13 == b.e13 &&
+          a.e21 == b.e21 && a.e22 == b.e22 && a.e23 == b.e23;
+}
+
+static const Matrix IdentityMatrix = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+
+//Draws must hold still this many frames before they're baked, so that
+//something pausing for a frame doesn't get baked and dropped right away.
+static const uint32_t StableFrames = 3;
+
+static unique_ptr<Shape> rectShape(const float* rect)
+{
+   auto shape = tvg::Shape::gen();
+   shape->appendRect(rect[0], rect[1], rect[2] - rect[0], rect[3] - rect[1], 0, 0);
+   return shape;
+}
+
+//Rectangle clips are passed as a plain canvas space rectangle: thorvg then
+//narrows the viewport instead of masking (Paint::Impl::update() and
+//_compFastTrack() in tvgPaint.cpp), which it only does for 4 point shapes.
+static unique_ptr<Shape> clipShape(const Shape* geometry, const Matrix& transform, const float* rect)
+{
+   if (rect)
+   {
+      auto shape = rectShape(rect);
+      shape->fill(255, 255, 255, 255);
+      return shape;
+   }
+   auto shape = unique_ptr<Shape>(static_cast<Shape*>(geometry->duplicate()));
+   shape->fill(255, 255, 255, 255);
+   //A fresh duplicate is untransformed, identity needs no call.
+   if (!sameMatrix(transform, IdentityMatrix)) shape->transform(transform);
+   return shape;
+}
+
+TvgRenderPath::~TvgRenderPath()
+{
+   for (auto& cache : strokeCaches)
+   {
+      if (cache.shape) TvgMemory::shapes -= TvgMemory::shapeBytes(cache.shape.get());
+   }
+}
+
+void TvgRenderPath::release(bool pathData)
+{
+   for (auto& cache : strokeCaches)
+   {
+      if (cache.shape) TvgMemory::shapes -= TvgMemory::shapeBytes(cache.shape.get());
+   }
+   vector<TvgStrokeCache>().swap(strokeCaches);
+   if (!pathData) return;
+   tvgShape.reset();
+   geometry.reset();
+   dirty = true;
+}
+
+size_t TvgRenderPath::bytes() const
+{
+   size_t bytes = tvgShape ? TvgMemory::shapeBytes(tvgShape.get()) : 0;
+   for (auto& cache : strokeCaches)
+   {
+      if (cache.shape) bytes += TvgMemory::shapeBytes(cache.shape.get());
+   }
+   return bytes;
+}
+
+TvgStrokeCache* TvgRenderPath::strokeCache(uint32_t paintId)
+{
+   for (auto& cache : strokeCaches)
+   {
+      if (cache.paintId == paintId) return &cache;
+   }
+   strokeCaches.emplace_back();
+   strokeCaches.back().paintId = paintId;
+   return &strokeCaches.back();
+}
+
+Shape* TvgRenderPath::recording()
+{
+   if (!tvgShape) tvgShape = tvg::Shape::gen();
+   dirty = true;
+   return tvgShape.get();
+}
+
+const Shape* TvgRenderPath::shape(uint32_t frame)
+{
+   //Changed in this many frames in a row, the path counts as animated.
+   static const uint32_t AnimatedFrames = 2;
+
+   bool settled = false;
+   if (frame != 0 && frame != drawnFrame)
+   {
+      drawnFrame = frame;
+      if (dirty) ++changedFrames;
+      else
+      {
+         settled = changedFrames >= AnimatedFrames;
+         changedFrames = 0;
+      }
+   }
+
+   if (dirty)
+   {
+      //Identical paths end up sharing one geometry and drop their own copy.
+      //Without a recording only the rule changed, the path data stays.
+      unique_ptr<Shape> shape;
+      if (tvgShape) shape = move(tvgShape);
+      else if (geometry) shape.reset(static_cast<Shape*>(geometry->shape->duplicate()));
+      else shape = tvg::Shape::gen();
+      shape->fill(rule);
+      if (changedFrames >= AnimatedFrames) geometry = TvgGeometryPool::adopt(move(shape));
+      else geometry = TvgGeometryPool::intern(move(shape));
+      dirty = false;
+   }
+   else if (settled && !geometry->pooled)
+   {
+      //Held still for a frame after an animation, it may share again.
+      geometry = TvgGeometryPool::intern(unique_ptr<Shape>(static_cast<Shape*>(geometry->shape->duplicate())));
+   }
+   return geometry->shape.get();
+}
+
 void TvgRenderPath::reset()
 {
-   tvgShape->reset();
+   recording()->reset();
 }
 
 void TvgRenderPath::addRenderPath(RenderPath* path, const Mat2D& transform)
 {
+   auto source = static_cast<TvgRenderPath*>(path)->shape();
+
    const Point* pts;
-   auto ptsCnt = static_cast<TvgRenderPath*>(path)->tvgShape->pathCoords(&pts);
+   auto ptsCnt = source->pathCoords(&pts);
    if (!pts) return;
 
    const PathCommand* cmds;
-   auto cmdCnt = static_cast<TvgRenderPath*>(path)->tvgShape->pathCommands(&cmds);
+   auto cmdCnt = source->pathCommands(&cmds);
    if (!cmds) return;
 
+   auto shape = recording();
+
    //Capture the last coordinates
    Point* pts2;
-   auto ptsCnt2 = tvgShape->pathCoords(const_cast<const Point**>(&pts2));
+   auto ptsCnt2 = shape->pathCoords(const_cast<const Point**>(&pts2));
 
-   tvgShape->appendPath(cmds, cmdCnt, pts, ptsCnt);
+   shape->appendPath(cmds, cmdCnt, pts, ptsCnt);
 
    //Immediate Transform for the newly appended
    Point* pts3;
-   auto ptsCnt3 = tvgShape->pathCoords(const_cast<const Point**>(&pts3));
+   auto ptsCnt3 = shape->pathCoords(const_cast<const Point**>(&pts3));
 
    for (unsigned i = ptsCnt2; i < ptsCnt3; ++i)
    {
@@ -64,22 +426,22 @@ void TvgRenderPath::addRenderPath(RenderPath* path, const Mat2D& transform)
 
 void TvgRenderPath::moveTo(float x, float y)
 {
-   tvgShape->moveTo(x, y);
+   recording()->moveTo(x, y);
 }
 
 void TvgRenderPath::lineTo(float x, float y)
 {
-   tvgShape->lineTo(x, y);
+   recording()->lineTo(x, y);
 }
 
 void TvgRenderPath::cubicTo(float ox, float oy, float ix, float iy, float x, float y)
 {
-   tvgShape->cubicTo(ox, oy, ix, iy, x, y);
+   recording()->cubicTo(ox, oy, ix, iy, x, y);
 }
 
 void TvgRenderPath::close()
 {
-   tvgShape->close();
+   recording()->close();
 }
 
 void TvgRenderPaint::style(RenderPaintStyle style)
@@ -132,13 +494,26 @@ void TvgRenderPaint::cap(StrokeCap value)
    }
 }
 
+TvgRenderPaint::~TvgRenderPaint()
+{
+   if (m_Paint.gradientFill)
+   {
+      TvgMemory::fills -= TvgMemory::fillBytes(m_Paint.gradientFill);
+      delete m_Paint.gradientFill;
+   }
+   delete m_GradientBuilder;
+}
+
 void TvgRenderPaint::linearGradient(float sx, float sy, float ex, float ey)
 {
+   //An unfinished gradient gets replaced.
+   delete m_GradientBuilder;
    m_GradientBuilder = new TvgLinearGradientBuilder(sx, sy, ex, ey);
 }
 
 void TvgRenderPaint::radialGradient(float sx, float sy, float ex, float ey)
 {
+   delete m_GradientBuilder;
    m_GradientBuilder = new TvgRadialGradientBuilder(sx, sy, ex, ey);
 }
 
@@ -150,12 +525,26 @@ void TvgRenderPaint::addStop(unsigned int color, float stop)
 void TvgRenderPaint::completeGradient()
 {
    m_GradientBuilder->make(&m_Paint);
+   ++m_Paint.gradientVersion;
    delete m_GradientBuilder;
+   m_GradientBuilder = nullptr;
 }
 
-void TvgRenderPaint::blendMode(BlendMode value)
+//Replaces the previous gradient of the paint, draws only ever hold copies of it.
+static void setGradient(TvgPaint* paint, tvg::Fill* fill)
 {
+   if (paint->gradientFill)
+   {
+      TvgMemory::fills -= TvgMemory::fillBytes(paint->gradientFill);
+      delete paint->gradientFill;
+   }
+   paint->gradientFill = fill;
+   TvgMemory::fills += TvgMemory::fillBytes(fill);
+}
 
+void TvgRenderPaint::blendMode(BlendMode value)
+{
+   m_Paint.blendMode = value;
 }
 
 void TvgRadialGradientBuilder::make(TvgPaint* paint)
@@ -163,9 +552,9 @@ void TvgRadialGradientBuilder::make(TvgPaint* paint)
    paint->isGradient = true;
    int numStops = stops.size();
 
-   paint->gradientFill = tvg::RadialGradient::gen().release();
+   auto fill = tvg::RadialGradient::gen().release();
    float radius = Vec2D::distance(Vec2D(sx, sy), Vec2D(ex, ey));
-   static_cast<RadialGradient*>(paint->gradientFill)->radial(sx, sy, radius);
+   fill->radial(sx, sy, radius);
 
    tvg::Fill::ColorStop colorStops[numStops];
    for (int i = 0; i < numStops; i++)
@@ -179,7 +568,8 @@ void TvgRadialGradientBuilder::make(TvgPaint* paint)
       colorStops[i] = {stops[i].stop, r, g, b, a};
    }
 
-   static_cast<RadialGradient*>(paint->gradientFill)->colorStops(colorStops, numStops);
+   fill->colorStops(colorStops, numStops);
+   setGradient(paint, fill);
 }
 
 void TvgLinearGradientBuilder::make(TvgPaint* paint)
@@ -187,8 +577,8 @@ void TvgLinearGradientBuilder::make(TvgPaint* paint)
    paint->isGradient = true;
    int numStops = stops.size();
 
-   paint->gradientFill = tvg::LinearGradient::gen().release();
-   static_cast<LinearGradient*>(paint->gradientFill)->linear(sx, sy, ex, ey);
+   auto fill = tvg::LinearGradient::gen().release();
+   fill->linear(sx, sy, ex, ey);
 
    tvg::Fill::ColorStop colorStops[numStops];
    for (int i = 0; i < numStops; i++)
@@ -202,36 +592,776 @@ void TvgLinearGradientBuilder::make(TvgPaint* paint)
       colorStops[i] = {stops[i].stop, r, g, b, a};
    }
 
-   static_cast<LinearGradient*>(paint->gradientFill)->colorStops(colorStops, numStops);
+   fill->colorStops(colorStops, numStops);
+   setGradient(paint, fill);
+}
+
+#ifdef THORVG_BLEND_SUPPORT
+static bool toBlendMethod(BlendMode mode, tvg::BlendMethod* method)
+{
+   switch (mode)
+   {
+      case BlendMode::screen: *method = tvg::BlendMethod::Screen; return true;
+      case BlendMode::overlay: *method = tvg::BlendMethod::Overlay; return true;
+      case BlendMode::darken: *method = tvg::BlendMethod::Darken; return true;
+      case BlendMode::lighten: *method = tvg::BlendMethod::Lighten; return true;
+      case BlendMode::colorDodge: *method = tvg::BlendMethod::ColorDodge; return true;
+      case BlendMode::colorBurn: *method = tvg::BlendMethod::ColorBurn; return true;
+      case BlendMode::hardLight: *method = tvg::BlendMethod::HardLight; return true;
+      case BlendMode::softLight: *method = tvg::BlendMethod::SoftLight; return true;
+      case BlendMode::difference: *method = tvg::BlendMethod::Difference; return true;
+      case BlendMode::exclusion: *method = tvg::BlendMethod::Exclusion; return true;
+      case BlendMode::multiply: *method = tvg::BlendMethod::Multiply; return true;
+      //srcOver and the non-separable modes thorvg doesn't provide.
+      default: return false;
+   }
+}
+#endif
+
+static bool needsLayer(BlendMode mode)
+{
+#ifdef THORVG_BLEND_SUPPORT
+   tvg::BlendMethod method;
+   return toBlendMethod(mode, &method);
+#else
+   return false;
+#endif
+}
+
+TvgRenderer::TvgRenderer(Canvas* canvas, bool retained) : m_Canvas(canvas), m_Retained(retained)
+{
+   if (m_Retained)
+   {
+      m_Root = tvg::Scene::gen();
+      m_Canvas->push(unique_ptr<Paint>(m_Root.get()));
+   }
+}
+
+TvgRenderer::~TvgRenderer()
+{
+   //The canvas must not free the paints owned by us or by the stroke caches.
+   if (m_Retained)
+   {
+      m_Root->clear(false);
+      m_Canvas->clear(false);
+   }
+   else flush();
+}
+
+void TvgRenderer::viewport(float width, float height)
+{
+   //Static layers are rasterized at the current size.
+   if (m_Viewport[2] != width || m_Viewport[3] != height) invalidateLayers();
+   m_Viewport[2] = width;
+   m_Viewport[3] = height;
+}
+
+void TvgRenderer::quality(float minStrokeWidth, float minDrawSize)
+{
+   m_MinStrokeWidth = minStrokeWidth;
+   m_MinDrawSize = minDrawSize;
+}
+
+void TvgRenderer::layerBaking(bool enabled)
+{
+   m_Baking = enabled && m_Retained;
+   if (!m_Baking) invalidateLayers();
+}
+
+void TvgRenderer::invalidateLayers()
+{
+   //Baked pictures may still be linked to the root until the next commit.
+   if (m_Root) m_Root->clear(false);
+   m_BakedLayers.clear();
+   m_BakedPixels = 0;
+   m_StableDraws.clear();
+}
+
+void TvgRenderer::beginFrame()
+{
+   //The last frame stays in the canvas until this one is committed.
+   for (auto& paint : m_FramePaints) m_PrevFramePaints.push_back(move(paint));
+   m_FramePaints.clear();
+   m_PrevFrameBytes += m_FrameBytes;
+   m_FrameBytes = 0;
+   m_Commands.clear();
+   m_LayerDraw.reset();
+   m_Layer.reset();
+   m_HitRecords.clear();
+   m_HitDirty = true;
+   ++m_Frame;
+   //0 is the id of paints never counted.
+   m_FrameId = ++s_NextFrameId;
+   if (m_FrameId == 0) m_FrameId = ++s_NextFrameId;
+   m_FillBytes = 0;
+
+   m_Clips = TvgClipState();
+   resetTransform();
+}
+
+TvgClipState TvgRenderer::resetClips()
+{
+   auto state = m_Clips;
+   m_Clips = TvgClipState();
+   return state;
+}
+
+void TvgRenderer::restoreClips(const TvgClipState& state)
+{
+   m_Clips = state;
+}
+
+void TvgRenderer::reset()
+{
+   invalidateLayers();
+   m_Root->clear(false);
+   m_HitRecords.clear();
+   m_HitIndex.clear();
+   m_Commands.clear();
+   m_LayerDraw.reset();
+   m_Layer.reset();
+   m_FramePaints.clear();
+   m_PrevFramePaints.clear();
+   m_FrameBytes = 0;
+   m_PrevFrameBytes = 0;
+   m_FillBytes = 0;
+}
+
+void TvgRenderer::hitTesting(bool enabled)
+{
+   m_HitTesting = enabled;
+   if (!enabled)
+   {
+      m_HitRecords.clear();
+      m_HitIndex.clear();
+   }
+}
+
+const RenderPath* TvgRenderer::hitTest(float x, float y)
+{
+   //Pointer events come at most a few times per frame, refit once for all of them.
+   if (m_HitDirty)
+   {
+      m_HitIndex.update(m_HitRecords);
+      m_HitDirty = false;
+   }
+   int hit = m_HitIndex.query(m_HitRecords, x, y);
+   return hit < 0 ? nullptr : m_HitRecords[hit].path;
+}
+
+void TvgRenderer::record(Paint* paint, const float* bounds, const float* opaqueRect)
+{
+   TvgDrawCommand cmd;
+   cmd.paint = paint;
+   cmd.hasBounds = bounds != nullptr;
+   if (bounds) memcpy(cmd.bounds, bounds, sizeof(cmd.bounds));
+   cmd.opaque = opaqueRect != nullptr;
+   if (opaqueRect) memcpy(cmd.opaqueRect, opaqueRect, sizeof(cmd.opaqueRect));
+   cmd.culled = false;
+   cmd.signature = m_DrawSignature;
+   //Opaque draws stay out, they are cheap and feed the occlusion pass.
+   cmd.bakeable = m_DrawStable && bounds != nullptr && opaqueRect == nullptr;
+   m_DrawStable = false;
+   m_Commands.push_back(cmd);
+}
+
+void TvgRenderer::push(unique_ptr<Paint> paint, const float* bounds, const float* opaqueRect)
+{
+   if (m_Retained)
+   {
+      record(paint.get(), bounds, opaqueRect);
+      m_FramePaints.push_back(move(paint));
+   }
+   else m_Canvas->push(move(paint));
+}
+
+static float area(const float* bounds)
+{
+   return (bounds[2] - bounds[0]) * (bounds[3] - bounds[1]);
+}
+
+bool TvgRenderer::joinsLayer(BlendMode mode, const float* bounds) const
+{
+   //A layer may be at most this much larger than the draws it holds.
+   static const float MaxLayerWaste = 2.0f;
+
+   //Draws inside a layer composite src-over before the layer blends,
+   //so only draws that don't overlap may share one.
+   if (m_LayerMode != mode || !m_LayerHasBounds || !bounds || overlaps(m_LayerBounds, bounds)) return false;
+
+   //Note: thorvg sizes the scene composition to its content bounds, so the
+   //offscreen pass costs the union of the draws, empty space in between included.
+   float merged[4] = {fminf(m_LayerBounds[0], bounds[0]), fminf(m_LayerBounds[1], bounds[1]),
+                      fmaxf(m_LayerBounds[2], bounds[2]), fmaxf(m_LayerBounds[3], bounds[3])};
+   return area(merged) <= MaxLayerWaste * (m_LayerArea + area(bounds));
+}
+
+void TvgRenderer::emit(unique_ptr<Paint> paint, BlendMode mode, const float* bounds, const float* opaqueRect)
+{
+#ifdef THORVG_BLEND_SUPPORT
+   tvg::BlendMethod method;
+   if (toBlendMethod(mode, &method))
+   {
+      if ((m_LayerDraw || m_Layer) && !joinsLayer(mode, bounds)) closeLayer();
+      if (!m_LayerDraw && !m_Layer)
+      {
+         //Held back until the next draw tells whether it stays alone.
+         m_LayerDraw = move(paint);
+         m_LayerMode = mode;
+         m_LayerHasBounds = bounds != nullptr;
+         if (bounds)
+         {
+            memcpy(m_LayerBounds, bounds, sizeof(m_LayerBounds));
+            m_LayerArea = area(bounds);
+         }
+         return;
+      }
+      if (!m_Layer)
+      {
+         m_Layer = tvg::Scene::gen();
+         m_Layer->blend(method);
+         m_Layer->push(move(m_LayerDraw));
+      }
+      m_LayerBounds[0] = fminf(m_LayerBounds[0], bounds[0]);
+      m_LayerBounds[1] = fminf(m_LayerBounds[1], bounds[1]);
+      m_LayerBounds[2] = fmaxf(m_LayerBounds[2], bounds[2]);
+      m_LayerBounds[3] = fmaxf(m_LayerBounds[3], bounds[3]);
+      m_LayerArea += area(bounds);
+      m_Layer->push(move(paint));
+      return;
+   }
+#endif
+   //src-over draws never go through a layer.
+   closeLayer();
+   push(move(paint), bounds, opaqueRect);
+}
+
+void TvgRenderer::closeLayer()
+{
+   if (!m_LayerDraw && !m_Layer) return;
+   //Blend layers are never baked, and must not take the pending draw's state.
+   auto stable = m_DrawStable;
+   m_DrawStable = false;
+   auto bounds = m_LayerHasBounds ? m_LayerBounds : nullptr;
+#ifdef THORVG_BLEND_SUPPORT
+   //A lone draw blends straight into the target, no offscreen pass.
+   if (m_LayerDraw)
+   {
+      tvg::BlendMethod method;
+      toBlendMethod(m_LayerMode, &method);
+      m_LayerDraw->blend(method);
+      push(move(m_LayerDraw), bounds, nullptr);
+   }
+#endif
+   if (m_Layer) push(move(m_Layer), bounds, nullptr);
+   m_DrawStable = stable;
+}
+
+void TvgRenderer::flush()
+{
+   closeLayer();
+   if (m_Retained) commit();
+}
+
+void TvgRenderer::commit()
+{
+   //Walk back to front: a draw inside the opaque area of a later draw is never visible,
+   //and once the whole target is covered nothing below it is either.
+   static const size_t MaxOccluders = 16;
+   bool covered = false;
+   m_Occluders.clear();
+
+   if (m_Baking) bake();
+
+   for (auto cmd = m_Commands.rbegin(); cmd != m_Commands.rend(); ++cmd)
+   {
+      if (covered)
+      {
+         cmd->culled = true;
+         continue;
+      }
+      if (cmd->hasBounds)
+      {
+         for (auto occluder : m_Occluders)
+         {
+            if (contains(occluder, cmd->bounds))
+            {
+               cmd->culled = true;
+               break;
+            }
+         }
+      }
+      if (cmd->culled || !cmd->opaque) continue;
+
+      if (m_Viewport[2] > 0 && contains(cmd->opaqueRect, m_Viewport)) covered = true;
+      else if (m_Occluders.size() < MaxOccluders) m_Occluders.push_back(cmd->opaqueRect);
+   }
+
+   m_Root->clear(false);
+   m_PrevFramePaints.clear();
+   m_PrevFrameBytes = 0;
+   //Only now the previous frame's pictures are unlinked.
+   if (m_Baking) evictLayers();
+
+   for (auto& cmd : m_Commands)
+   {
+      if (!cmd.culled) m_Root->push(unique_ptr<Paint>(cmd.paint));
+   }
+   m_Commands.clear();
+
+   //Note: Covered frames save no clear, thorvg clears the target inside
+   //draw() anyway (SwRenderer::preRender() -> rasterClear()).
+   m_Canvas->clear(false);
+   m_Canvas->push(unique_ptr<Paint>(m_Root.get()));
+}
+
+size_t TvgRenderer::drawSignature(const TvgRenderPath* path, const TvgPaint* paint, const Shape* clip,
+                                  const Shape* bgClip)
+{
+   //Geometry is content hashed, paints and transforms are hashed by value.
+   size_t hash = 14695981039346656037ULL;
+   hash = hashBytes(hash, &path->geometry->hash, sizeof(size_t));
+   hash = hashBytes(hash, paint->color, sizeof(paint->color));
+   hash = hashBytes(hash, &paint->thickness, sizeof(paint->thickness));
+   hash = hashBytes(hash, &paint->join, sizeof(paint->join));
+   hash = hashBytes(hash, &paint->cap, sizeof(paint->cap));
+   hash = hashBytes(hash, &paint->style, sizeof(paint->style));
+   hash = hashBytes(hash, &paint->blendMode, sizeof(paint->blendMode));
+   hash = hashBytes(hash, &paint->isGradient, sizeof(paint->isGradient));
+   hash = hashBytes(hash, &paint->id, sizeof(paint->id));
+   hash = hashBytes(hash, &paint->gradientVersion, sizeof(paint->gradientVersion));
+   hash = hashBytes(hash, &matrix(), sizeof(Matrix));
+   if (clip)
+   {
+      hash = hashBytes(hash, &m_Clips.clipHash, sizeof(m_Clips.clipHash));
+      hash = hashBytes(hash, &m_Clips.clipTransform, sizeof(Matrix));
+   }
+   if (bgClip)
+   {
+      hash = hashBytes(hash, &m_Clips.bgClipHash, sizeof(m_Clips.bgClipHash));
+      hash = hashBytes(hash, &m_Clips.bgClipTransform, sizeof(Matrix));
+   }
+   return hash;
+}
+
+void TvgRenderer::bake()
+{
+   //Shorter runs are cheaper to draw than to blit.
+   static const size_t MinBakeDraws = 3;
+
+   //Forget draws that are gone, their next appearance starts over.
+   for (auto it = m_StableDraws.begin(); it != m_StableDraws.end();)
+   {
+      if (it->second.seen != m_Frame) it = m_StableDraws.erase(it);
+      else ++it;
+   }
+
+   vector<TvgDrawCommand> commands;
+   bool baked = false;
+   auto cmd = m_Commands.cbegin();
+   while (cmd != m_Commands.cend())
+   {
+      auto last = cmd;
+      while (last != m_Commands.cend() && last->bakeable) ++last;
+      if (size_t(last - cmd) < MinBakeDraws || m_Viewport[2] <= 0)
+      {
+         if (last == cmd) ++last;
+         commands.insert(commands.end(), cmd, last);
+         cmd = last;
+         continue;
+      }
+
+      size_t hash = 14695981039346656037ULL;
+      for (auto it = cmd; it != last; ++it) hash = hashBytes(hash, &it->signature, sizeof(size_t));
+
+      auto layer = m_BakedLayers.find(hash);
+      if (layer == m_BakedLayers.end())
+      {
+         TvgBakedLayer fresh;
+         if (bakeLayer(cmd, last, fresh)) layer = m_BakedLayers.emplace(hash, move(fresh)).first;
+      }
+
+      if (layer == m_BakedLayers.end())
+      {
+         commands.insert(commands.end(), cmd, last);
+      }
+      else
+      {
+         layer->second.frame = m_Frame;
+         TvgDrawCommand blit;
+         blit.paint = layer->second.picture.get();
+         memcpy(blit.bounds, layer->second.bounds, sizeof(blit.bounds));
+         blit.signature = hash;
+         blit.hasBounds = true;
+         blit.opaque = false;
+         blit.culled = false;
+         blit.bakeable = false;
+         commands.push_back(blit);
+         baked = true;
+      }
+      cmd = last;
+   }
+   if (baked) m_Commands.swap(commands);
+}
+
+void TvgRenderer::evictLayers()
+{
+   //Layers not blitted this frame are out of date.
+   for (auto it = m_BakedLayers.begin(); it != m_BakedLayers.end();)
+   {
+      if (it->second.frame != m_Frame)
+      {
+         m_BakedPixels -= it->second.pixels.size();
+         it = m_BakedLayers.erase(it);
+      }
+      else ++it;
+   }
+}
+
+bool TvgRenderer::bakeLayer(vector<TvgDrawCommand>::const_iterator first, vector<TvgDrawCommand>::const_iterator last,
+                            TvgBakedLayer& layer)
+{
+   //Static layers may take up to twice the target in memory.
+   static const float MaxBakedTargets = 2.0f;
+
+   float bounds[4] = {FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX};
+   for (auto cmd = first; cmd != last; ++cmd)
+   {
+      bounds[0] = fminf(bounds[0], cmd->bounds[0]);
+      bounds[1] = fminf(bounds[1], cmd->bounds[1]);
+      bounds[2] = fmaxf(bounds[2], cmd->bounds[2]);
+      bounds[3] = fmaxf(bounds[3], cmd->bounds[3]);
+   }
+   intersect(bounds, m_Viewport);
+
+   //Whole pixels, so the blit needs no resampling.
+   int x = static_cast<int>(floorf(bounds[0]));
+   int y = static_cast<int>(floorf(bounds[1]));
+   int w = static_cast<int>(ceilf(bounds[2])) - x;
+   int h = static_cast<int>(ceilf(bounds[3])) - y;
+   if (w <= 0 || h <= 0) return false;
+
+   size_t pixels = size_t(w) * h;
+   if (m_BakedPixels + pixels > MaxBakedTargets * m_Viewport[2] * m_Viewport[3]) return false;
+
+   layer.pixels.assign(pixels, 0);
+   auto canvas = tvg::SwCanvas::gen();
+   if (canvas->target(layer.pixels.data(), w, w, h, tvg::SwCanvas::ARGB8888) != tvg::Result::Success) return false;
+
+   //Note: src-over is associative, so drawing the run into a transparent
+   //buffer and blending that gives the same pixels as drawing it in place.
+   auto scene = tvg::Scene::gen();
+   for (auto cmd = first; cmd != last; ++cmd) scene->push(unique_ptr<Paint>(cmd->paint->duplicate()));
+   scene->translate(-x, -y);
+   canvas->push(move(scene));
+   if (canvas->draw() != tvg::Result::Success) return false;
+   canvas->sync();
+
+   layer.picture = tvg::Picture::gen();
+   if (layer.picture->load(layer.pixels.data(), w, h, false) != tvg::Result::Success) return false;
+   layer.picture->translate(x, y);
+   layer.bounds[0] = x;
+   layer.bounds[1] = y;
+   layer.bounds[2] = x + w;
+   layer.bounds[3] = y + h;
+   layer.frame = m_Frame;
+   m_BakedPixels += pixels;
+   return true;
+}
+
+void TvgRenderer::resetTransform()
+{
+   m_Transform = Mat2D();
+   m_TransformVersion = 0;
+   m_Identity = true;
+   m_SaveDepth = 0;
+}
+
+const Matrix& TvgRenderer::matrix()
+{
+   if (m_Identity) return IdentityMatrix;
+   if (m_MatrixVersion != m_TransformVersion)
+   {
+      m_Matrix = toMatrix(m_Transform);
+      m_MatrixVersion = m_TransformVersion;
+   }
+   return m_Matrix;
 }
 
 void TvgRenderer::save()
 {
-    m_SavedTransforms.push(m_Transform);
+   if (m_SaveDepth < MaxSaveDepth)
+   {
+      auto& saved = m_SavedTransforms[m_SaveDepth];
+      saved.transform = m_Transform;
+      saved.version = m_TransformVersion;
+      saved.identity = m_Identity;
+   }
+   ++m_SaveDepth;
 }
 
 void TvgRenderer::restore()
 {
-    // Check shouldn't be needed, but safest to check
-    if (m_SavedTransforms.size() > 0)
-    {
-        m_Transform = m_SavedTransforms.top();
-        m_SavedTransforms.pop();
-    }
+   // Check shouldn't be needed, but safest to check
+   if (m_SaveDepth == 0) return;
+   --m_SaveDepth;
+   if (m_SaveDepth >= MaxSaveDepth) return;
+
+   //Unchanged since the save, nothing to copy back.
+   auto& saved = m_SavedTransforms[m_SaveDepth];
+   if (saved.version == m_TransformVersion) return;
+   m_Transform = saved.transform;
+   m_TransformVersion = saved.version;
+   m_Identity = saved.identity;
 }
 
 void TvgRenderer::transform(const Mat2D& transform)
 {
-   m_Transform = m_Transform * transform;
+   bool linearIdentity = transform[0] == 1.0f && transform[1] == 0.0f &&
+                         transform[2] == 0.0f && transform[3] == 1.0f;
+   if (linearIdentity)
+   {
+      if (transform[4] == 0.0f && transform[5] == 0.0f) return;
+      //Pure translation only moves the origin.
+      m_Transform[4] += m_Transform[0] * transform[4] + m_Transform[2] * transform[5];
+      m_Transform[5] += m_Transform[1] * transform[4] + m_Transform[3] * transform[5];
+   }
+   else if (m_Identity) m_Transform = transform;
+   else m_Transform = m_Transform * transform;
+
+   //0 is kept for the identity of a new frame.
+   auto version = ++s_NextTransformVersion;
+   if (version == 0) version = ++s_NextTransformVersion;
+   m_TransformVersion = version;
+   m_Identity = false;
+}
+
+TvgStrokeCache* TvgRenderer::cachedStroke(TvgRenderPath* path, const TvgPaint* paint)
+{
+   //Draws holding still this long get their own stroked copy of the geometry.
+   static const uint32_t SteadyDraws = 3;
+
+   //A shape can live only once in the canvas, repeated draws fall back to copies.
+   //Paths outlive renderers, so the frame id must be unique across them.
+   auto cache = path->strokeCache(paint->id);
+   if (cache->frame == m_FrameId) return nullptr;
+   cache->frame = m_FrameId;
+
+   float scaleX = sqrt(m_Transform[0] * m_Transform[0] + m_Transform[1] * m_Transform[1]);
+   float scaleY = sqrt(m_Transform[2] * m_Transform[2] + m_Transform[3] * m_Transform[3]);
+
+   auto shape = path->shape();
+   if (cache->geometry != path->geometry ||
+       cache->thickness != paint->thickness || cache->join != paint->join ||
+       cache->cap != paint->cap || cache->scaleX != scaleX || cache->scaleY != scaleY)
+   {
+      if (cache->shape)
+      {
+         TvgMemory::shapes -= TvgMemory::shapeBytes(cache->shape.get());
+         cache->shape.reset();
+      }
+      cache->geometry = path->geometry;
+      cache->thickness = paint->thickness;
+      cache->join = paint->join;
+      cache->cap = paint->cap;
+      cache->scaleX = scaleX;
+      cache->scaleY = scaleY;
+      cache->steady = 0;
+   }
+
+   if (!cache->shape)
+   {
+      //Animated paths keep sharing the pooled geometry, drawn through per frame copies.
+      if (++cache->steady < SteadyDraws) return nullptr;
+      cache->shape.reset(static_cast<Shape*>(shape->duplicate()));
+      TvgMemory::shapes += TvgMemory::shapeBytes(shape);
+      cache->shape->stroke(paint->cap);
+      cache->shape->stroke(paint->join);
+      cache->shape->stroke(paint->thickness);
+      cache->transform = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+      cache->transformVersion = 0;
+      cache->painted = false;
+      cache->clipped = false;
+   }
+
+   //Re-sending an unchanged transform would make thorvg rebuild the outline.
+   if (cache->transformVersion != m_TransformVersion || m_TransformVersion == 0)
+   {
+      auto& matrix = this->matrix();
+      if (!sameMatrix(cache->transform, matrix))
+      {
+         cache->shape->transform(matrix);
+         cache->transform = matrix;
+      }
+      cache->transformVersion = m_TransformVersion;
+   }
+
+   //thorvg flags any stroke paint as a stroke change, even an identical one.
+   if (!paint->isGradient)
+   {
+      if (!cache->painted || cache->gradient || memcmp(cache->color, paint->color, sizeof(cache->color)))
+      {
+         cache->shape->stroke(paint->color[0], paint->color[1], paint->color[2], paint->color[3]);
+         memcpy(cache->color, paint->color, sizeof(cache->color));
+      }
+   }
+   else if (!cache->painted || !cache->gradient || cache->gradientVersion != paint->gradientVersion)
+   {
+      cache->shape->stroke(unique_ptr<tvg::Fill>(paint->gradientFill->duplicate()));
+      cache->gradientVersion = paint->gradientVersion;
+   }
+   cache->gradient = paint->isGradient;
+   cache->painted = true;
+
+   return cache;
 }
 
 void TvgRenderer::drawPath(RenderPath* path, RenderPaint* paint)
 {
-   auto tvgShape = static_cast<TvgRenderPath*>(path)->tvgShape.get();
+   auto renderPath = static_cast<TvgRenderPath*>(path);
    auto tvgPaint = static_cast<TvgRenderPaint*>(paint)->paint();
 
-   /* OPTIMIZE ME: Stroke / Fill Paints required to draw separately.
-      thorvg doesn't need to handle both, we can avoid one of them rendering... */
+   //Gradients aren't pooled, every paint drawn this frame is counted once.
+   if (m_Retained && tvgPaint->countedFrame != m_FrameId)
+   {
+      tvgPaint->countedFrame = m_FrameId;
+      if (tvgPaint->gradientFill) m_FillBytes += TvgMemory::fillBytes(tvgPaint->gradientFill);
+   }
+
+   //The shape clip applies to the next draw only.
+   auto clip = m_Clips.clipPath;
+   auto bgClip = m_Clips.bgClipPath;
+   m_Clips.clipPath = nullptr;
+
+   float bounds[4];
+   auto shape = renderPath->shape(m_FrameId);
+   bool hasBounds = drawBounds(shape, tvgPaint, m_Transform, bounds);
+
+   //Reduced quality: details that cost more than they show.
+   if (m_MinStrokeWidth > 0 && tvgPaint->style == RenderPaintStyle::stroke)
+   {
+      float scaleX = sqrt(m_Transform[0] * m_Transform[0] + m_Transform[1] * m_Transform[1]);
+      float scaleY = sqrt(m_Transform[2] * m_Transform[2] + m_Transform[3] * m_Transform[3]);
+      if (tvgPaint->thickness * fmaxf(scaleX, scaleY) < m_MinStrokeWidth) return;
+   }
+   if (m_MinDrawSize > 0 && hasBounds &&
+       bounds[2] - bounds[0] < m_MinDrawSize && bounds[3] - bounds[1] < m_MinDrawSize) return;
+
+   auto clipTransform = m_Clips.clipTransform;
+   auto clipRect = m_Clips.clipIsRect ? m_Clips.clipRect : nullptr;
+   auto bgClipRect = m_Clips.bgClipIsRect ? m_Clips.bgClipRect : nullptr;
+
+   //Rectangular clips don't need a mask when the draw is fully inside,
+   //and the draw can be dropped when it's fully outside.
+   if ((clip && m_Clips.clipIsRect) || (bgClip && m_Clips.bgClipIsRect))
+   {
+      if (hasBounds)
+      {
+         if (clip && m_Clips.clipIsRect)
+         {
+            if (!overlaps(m_Clips.clipRect, bounds)) return;
+            if (contains(m_Clips.clipRect, bounds)) clip = nullptr;
+         }
+         if (bgClip && m_Clips.bgClipIsRect)
+         {
+            if (!overlaps(m_Clips.bgClipRect, bounds)) return;
+            if (contains(m_Clips.bgClipRect, bounds)) bgClip = nullptr;
+         }
+      }
+   }
+
+   if (m_Baking)
+   {
+      m_DrawSignature = drawSignature(renderPath, tvgPaint, clip, bgClip);
+      size_t key = hashBytes(14695981039346656037ULL, &path, sizeof(path));
+      key = hashBytes(key, &tvgPaint->id, sizeof(tvgPaint->id));
+      auto& stable = m_StableDraws[key];
+      if (stable.signature != m_DrawSignature || stable.seen + 1 != m_Frame)
+      {
+         stable.signature = m_DrawSignature;
+         stable.since = m_Frame;
+      }
+      stable.seen = m_Frame;
+      //Blend layers go through their own scene, they are never baked.
+      m_DrawStable = hasBounds && !needsLayer(tvgPaint->blendMode) && m_Frame - stable.since >= StableFrames;
+   }
+
+   if (m_HitTesting && hasBounds)
+   {
+      //Note: Only rectangular clips narrow the hit area.
+      TvgHitRecord hit;
+      hit.path = path;
+      hit.geometry = renderPath->geometry;
+      hit.transform = matrix();
+      memcpy(hit.bounds, bounds, sizeof(bounds));
+      if (clip && m_Clips.clipIsRect) intersect(hit.bounds, m_Clips.clipRect);
+      if (bgClip && m_Clips.bgClipIsRect) intersect(hit.bounds, m_Clips.bgClipRect);
+      hit.thickness = tvgPaint->style == RenderPaintStyle::stroke ? tvgPaint->thickness : 0.0f;
+      m_HitRecords.push_back(move(hit));
+   }
+
+   //A solid rectangle crossing rectangular clips is drawn as the part inside them, unmasked.
+   float clippedRect[4];
+   bool clippedFill = (clip || bgClip) && (!clip || m_Clips.clipIsRect) && (!bgClip || m_Clips.bgClipIsRect) &&
+                      tvgPaint->style == RenderPaintStyle::fill && !tvgPaint->isGradient &&
+                      pathRect(shape, m_Transform, clippedRect);
+   if (clippedFill)
+   {
+      if (clip) intersect(clippedRect, m_Clips.clipRect);
+      if (bgClip) intersect(clippedRect, m_Clips.bgClipRect);
+      if (clippedRect[0] >= clippedRect[2] || clippedRect[1] >= clippedRect[3]) return;
+      memcpy(bounds, clippedRect, sizeof(bounds));
+      clip = nullptr;
+      bgClip = nullptr;
+   }
+
+   //Note: Every draw gets its own shape carrying only this paint,
+   //so stroke and fill paints of the same path are rasterized separately.
+   TvgStrokeCache* cache = nullptr;
+   if (m_Retained && tvgPaint->style == RenderPaintStyle::stroke &&
+       !needsLayer(tvgPaint->blendMode) && !(clip && bgClip))
+   {
+      cache = cachedStroke(renderPath, tvgPaint);
+   }
+
+   if (cache)
+   {
+      //Only one of the clips is set here, so no wrapping scene is needed.
+      if (clip || bgClip)
+      {
+         auto mask = clip ? clipShape(clip, clipTransform, clipRect) : clipShape(bgClip, m_Clips.bgClipTransform, bgClipRect);
+         cache->shape->composite(move(mask), tvg::CompositeMethod::ClipPath);
+         cache->clipped = true;
+      }
+      else if (cache->clipped)
+      {
+         cache->shape->composite(nullptr, tvg::CompositeMethod::None);
+         cache->clipped = false;
+      }
+      closeLayer();
+      record(cache->shape.get(), hasBounds ? bounds : nullptr, nullptr);
+      return;
+   }
+
+   //Opaque solid rectangles hide whatever was drawn below them.
+   float opaqueRect[4];
+   bool opaque = m_Retained && hasBounds && tvgPaint->style == RenderPaintStyle::fill &&
+                 !tvgPaint->isGradient && tvgPaint->color[3] == 255 && !needsLayer(tvgPaint->blendMode) &&
+                 (!clip || m_Clips.clipIsRect) && (!bgClip || m_Clips.bgClipIsRect) &&
+                 (clippedFill || pathRect(shape, m_Transform, opaqueRect));
+   if (opaque)
+   {
+      if (clippedFill) memcpy(opaqueRect, clippedRect, sizeof(opaqueRect));
+      if (clip) intersect(opaqueRect, m_Clips.clipRect);
+      if (bgClip) intersect(opaqueRect, m_Clips.bgClipRect);
+      opaque = opaqueRect[0] < opaqueRect[2] && opaqueRect[1] < opaqueRect[3];
+   }
+
+   //Per instance copy of the shared geometry, carrying this draw's transform and paint.
+   unique_ptr<Shape> tvgShape;
+   if (clippedFill) tvgShape = rectShape(clippedRect);
+   else tvgShape.reset(static_cast<Shape*>(shape->duplicate()));
+   if (m_Retained) m_FrameBytes += TvgMemory::shapeBytes(tvgShape.get());
 
    if (tvgPaint->style == RenderPaintStyle::fill)
    {
@@ -256,40 +1386,44 @@ void TvgRenderer::drawPath(RenderPath* path, RenderPaint* paint)
       }
    }
 
-   if (m_ClipPath)
-   {
-      m_ClipPath->fill(255, 255, 255, 255);
-      tvgShape->composite(unique_ptr<Shape>(static_cast<Shape*>(m_ClipPath->duplicate())), tvg::CompositeMethod::ClipPath);
-      m_ClipPath = nullptr;
-   }
-
-   tvgShape->transform({m_Transform[0], m_Transform[2], m_Transform[4], m_Transform[1], m_Transform[3], m_Transform[5], 0, 0, 1});
+   //A fresh duplicate is untransformed, identity needs no call.
+   //The clipped rectangle is in canvas space already.
+   if (!m_Identity && !clippedFill) tvgShape->transform(matrix());
 
-   if (m_BgClipPath)
+   if (clip && bgClip)
    {
-      m_BgClipPath->fill(255, 255, 255, 255);
+      tvgShape->composite(clipShape(clip, clipTransform, clipRect), tvg::CompositeMethod::ClipPath);
       auto scene = tvg::Scene::gen();
-      scene->push(unique_ptr<Paint>(tvgShape->duplicate()));
-      scene->composite(unique_ptr<Shape>(static_cast<Shape*>(m_BgClipPath->duplicate())), tvg::CompositeMethod::ClipPath);
-      m_Canvas->push(move(scene));
+      scene->push(move(tvgShape));
+      scene->composite(clipShape(bgClip, m_Clips.bgClipTransform, bgClipRect), tvg::CompositeMethod::ClipPath);
+      emit(move(scene), tvgPaint->blendMode, hasBounds ? bounds : nullptr, opaque ? opaqueRect : nullptr);
+      return;
    }
-   else
-      m_Canvas->push(unique_ptr<Paint>(tvgShape->duplicate()));
+
+   if (clip) tvgShape->composite(clipShape(clip, clipTransform, clipRect), tvg::CompositeMethod::ClipPath);
+   else if (bgClip) tvgShape->composite(clipShape(bgClip, m_Clips.bgClipTransform, bgClipRect), tvg::CompositeMethod::ClipPath);
+   emit(move(tvgShape), tvgPaint->blendMode, hasBounds ? bounds : nullptr, opaque ? opaqueRect : nullptr);
 }
 
 
 void TvgRenderer::clipPath(RenderPath* path)
 {
    //Note: ClipPath transform matrix is calculated by transfrom matrix in addRenderPath function
-   if (!m_BgClipPath)
+   auto shape = static_cast<TvgRenderPath*>(path)->shape(m_FrameId);
+
+   if (!m_Clips.bgClipPath)
    {
-      m_BgClipPath = static_cast<TvgRenderPath*>(path)->tvgShape.get();
-      m_BgClipPath->transform({m_Transform[0], m_Transform[2], m_Transform[4], m_Transform[1], m_Transform[3], m_Transform[5], 0, 0, 1});
+      m_Clips.bgClipPath = shape;
+      m_Clips.bgClipHash = static_cast<TvgRenderPath*>(path)->geometry->hash;
+      m_Clips.bgClipTransform = matrix();
+      m_Clips.bgClipIsRect = pathRect(shape, m_Transform, m_Clips.bgClipRect);
    }
    else
    {
-      m_ClipPath = static_cast<TvgRenderPath*>(path)->tvgShape.get();
-      m_ClipPath->transform({m_Transform[0], m_Transform[2], m_Transform[4], m_Transform[1], m_Transform[3], m_Transform[5], 0, 0, 1});
+      m_Clips.clipPath = shape;
+      m_Clips.clipHash = static_cast<TvgRenderPath*>(path)->geometry->hash;
+      m_Clips.clipTransform = matrix();
+      m_Clips.clipIsRect = pathRect(shape, m_Transform, m_Clips.clipRect);
    }
 }
 
@@ -2,9 +2,13 @@
 #define _RIVE_THORVG_RENDERER_HPP_
 
 #include <thorvg.h>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
-#include <stack>
 #include "renderer.hpp"
+#include "tvg_hit_index.hpp"
 
 using namespace tvg;
 using namespace std;
@@ -13,20 +17,121 @@ namespace rive
 {
    struct TvgPaint
    {
+      uint32_t id = 0;
       uint8_t color[4];
       float thickness = 1.0f;
       tvg::Fill *gradientFill = nullptr;
       tvg::StrokeJoin join = tvg::StrokeJoin::Bevel;
       tvg::StrokeCap  cap = tvg::StrokeCap::Butt;
       RenderPaintStyle style = RenderPaintStyle::fill;
+      BlendMode blendMode = BlendMode::srcOver;
       bool isGradient = false;
+      //Bumped by every completed gradient, fill pointers may be reused.
+      uint32_t gradientVersion = 0;
+      //Frame id of the renderer that last counted the gradient, see fillBytes().
+      uint32_t countedFrame = 0;
+   };
+
+   //Process wide estimate of the heap held by thorvg objects of render
+   //paths (pooled geometry, stroke caches) and render paints (gradients).
+   struct TvgMemory
+   {
+      static atomic<size_t> shapes;
+      static atomic<size_t> fills;
+
+      //Path data and private data behind a thorvg shape, and behind a gradient.
+      static size_t shapeBytes(const Shape* shape);
+      static size_t fillBytes(const tvg::Fill* fill);
+   };
+
+   //Immutable path data, shared by every render path built with identical
+   //commands, points and fill rule. The shape never gets paint or transform.
+   struct TvgGeometry
+   {
+      unique_ptr<Shape> shape;
+      //Content hash of pooled geometry, a serial number of private one.
+      size_t hash = 0;
+      weak_ptr<TvgGeometry> self;
+      bool pooled = false;
+   };
+
+   //Content addressed storage of path geometry, so repeated drawables
+   //(particles, dots, bullets) keep a single copy of their path data.
+   class TvgGeometryPool
+   {
+   private:
+      mutex m_Mutex;
+      unordered_multimap<size_t, TvgGeometry*> m_Geometries;
+      static atomic<size_t> s_NextSerial;
+
+      //Never destroyed, geometry may still be released by threads or
+      //static destructors running after the library's statics are gone.
+      static TvgGeometryPool& instance();
+      static void release(TvgGeometry* geometry);
+      static void discard(TvgGeometry* geometry);
+
+   public:
+      static shared_ptr<TvgGeometry> intern(unique_ptr<Shape> shape);
+      //Geometry kept out of the pool: no hashing, no lock.
+      static shared_ptr<TvgGeometry> adopt(unique_ptr<Shape> shape);
+   };
+
+   //Stroked copy of a path kept alive across frames, so thorvg can reuse
+   //its stroke outline while only the color, opacity or gradient changes.
+   //A thorvg shape owns its path data, so the copy is only made once the
+   //geometry and stroke held still for a few draws, before that the entry
+   //keeps just the stroke state.
+   struct TvgStrokeCache
+   {
+      unique_ptr<Shape> shape;
+      uint32_t paintId = 0;
+      shared_ptr<TvgGeometry> geometry;
+      float thickness = 0.0f;
+      tvg::StrokeJoin join = tvg::StrokeJoin::Bevel;
+      tvg::StrokeCap cap = tvg::StrokeCap::Butt;
+      float scaleX = 0.0f;
+      float scaleY = 0.0f;
+      Matrix transform = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+      uint32_t transformVersion = 0;
+      //Last stroke paint sent, re-sending it would rebuild the outline too.
+      bool painted = false;
+      bool gradient = false;
+      uint8_t color[4] = {0, 0, 0, 0};
+      uint32_t gradientVersion = 0;
+      bool clipped = false;
+      //Frame id of the last draw, unique across renderers.
+      uint32_t frame = 0;
+      //Draws since the geometry or the stroke last changed.
+      uint32_t steady = 0;
    };
 
    struct TvgRenderPath : public RenderPath
    {
+      //Path being built, moved into the geometry pool once it's used.
       unique_ptr<Shape> tvgShape;
+      shared_ptr<TvgGeometry> geometry;
+      tvg::FillRule rule = tvg::FillRule::Winding;
+      bool dirty = true;
+      vector<TvgStrokeCache> strokeCaches;
+      //Frame id of the last draw and how many frames in a row it changed.
+      uint32_t drawnFrame = 0;
+      uint32_t changedFrames = 0;
+
+      ~TvgRenderPath();
+      //Low memory: drops the stroke caches and, with pathData, the geometry,
+      //which then has to be rebuilt before the next draw.
+      void release(bool pathData);
 
-      TvgRenderPath() : tvgShape(tvg::Shape::gen()) {}
+      //Heap owned by this path alone: its stroke caches and the path being
+      //built. The geometry is pooled and counted apart.
+      size_t bytes() const;
+
+      //Shared geometry of the path, interned on first use after a change.
+      //Paths changing every frame they're drawn in keep private geometry,
+      //they'd only churn the pool. The frame id is 0 outside of draws.
+      const Shape* shape(uint32_t frame = 0);
+      TvgStrokeCache* strokeCache(uint32_t paintId);
+      Shape* recording();
 
       void buildShape();
       void reset() override;
@@ -84,10 +189,13 @@ namespace rive
    class TvgRenderPaint : public RenderPaint
    {
    private:
+      static atomic<uint32_t> s_NextId;
       TvgPaint m_Paint;
       TvgGradientBuilder* m_GradientBuilder = nullptr;
 
    public:
+      TvgRenderPaint() { m_Paint.id = ++s_NextId; }
+      ~TvgRenderPaint();
       TvgPaint* paint() { return &m_Paint; }
       void style(RenderPaintStyle style) override;
       void color(unsigned int value) override;
@@ -102,17 +210,180 @@ namespace rive
       void completeGradient() override;
    };
 
+   //A draw recorded in retained mode, pushed to the canvas on flush().
+   struct TvgDrawCommand
+   {
+      Paint* paint;
+      float bounds[4];
+      //Canvas space rectangle the draw fully covers with opaque color.
+      float opaqueRect[4];
+      //Everything that decides the draw's pixels, see TvgRenderer::bake().
+      size_t signature;
+      bool hasBounds;
+      bool opaque;
+      bool culled;
+      //Unchanged for a few frames, may be baked into a static layer.
+      bool bakeable;
+   };
+
+   //Run of unchanging draws rasterized once and blitted as an image.
+   struct TvgBakedLayer
+   {
+      vector<uint32_t> pixels;
+      unique_ptr<Picture> picture;
+      float bounds[4];
+      uint32_t frame = 0;
+   };
+
+   //Last signature of a (path, paint) pair and since when it holds.
+   struct TvgStableDraw
+   {
+      size_t signature = 0;
+      uint32_t since = 0;
+      uint32_t seen = 0;
+   };
+
+   //Clips in effect: the first clipPath() of an artboard clips all its
+   //draws, the ones after it only the next draw.
+   struct TvgClipState
+   {
+      const Shape* clipPath = nullptr;
+      const Shape* bgClipPath = nullptr;
+      size_t clipHash = 0;
+      size_t bgClipHash = 0;
+      Matrix clipTransform;
+      Matrix bgClipTransform;
+      //Canvas space {minX, minY, maxX, maxY} of axis aligned rectangle clips.
+      float clipRect[4];
+      float bgClipRect[4];
+      bool clipIsRect = false;
+      bool bgClipIsRect = false;
+   };
+
    class TvgRenderer : public Renderer
    {
    private:
       Canvas* m_Canvas;
-      Shape* m_ClipPath = nullptr;
-      Shape* m_BgClipPath = nullptr;
+      TvgClipState m_Clips;
+      //Every change of m_Transform gets a new version, unique across
+      //renderers since stroke caches outlive them. Restoring a saved
+      //transform brings its version back. The thorvg matrix is only
+      //rebuilt when the version moved.
+      struct SavedTransform
+      {
+         Mat2D transform;
+         uint32_t version;
+         bool identity;
+      };
+      static const int MaxSaveDepth = 64;
       Mat2D m_Transform;
-      stack<Mat2D> m_SavedTransforms;
+      uint32_t m_TransformVersion = 0;
+      static atomic<uint32_t> s_NextTransformVersion;
+      bool m_Identity = true;
+      Matrix m_Matrix = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+      uint32_t m_MatrixVersion = 0;
+      SavedTransform m_SavedTransforms[MaxSaveDepth];
+      //May exceed MaxSaveDepth, deeper saves are counted but not stored.
+      int m_SaveDepth = 0;
+
+      const Matrix& matrix();
+      void resetTransform();
+
+      //Retained mode: pushed paints are owned by the renderer (per frame)
+      //or by the render paths (stroke caches) instead of the canvas.
+      //Draws are recorded and pushed into m_Root on flush().
+      bool m_Retained = false;
+      uint32_t m_Frame = 0;
+      unique_ptr<Scene> m_Root;
+      vector<unique_ptr<Paint>> m_FramePaints;
+      vector<unique_ptr<Paint>> m_PrevFramePaints;
+      //Unique across renderers, so a paint drawn by several is counted by each.
+      static atomic<uint32_t> s_NextFrameId;
+      uint32_t m_FrameId = 0;
+      size_t m_FillBytes = 0;
+      size_t m_FrameBytes = 0;
+      size_t m_PrevFrameBytes = 0;
+      vector<TvgDrawCommand> m_Commands;
+      vector<const float*> m_Occluders;
+      float m_Viewport[4] = {0, 0, 0, 0};
+
+      //Current run of disjoint same blend mode draws. A lone draw blends
+      //by itself, only a run of several shares an offscreen layer.
+      unique_ptr<Paint> m_LayerDraw;
+      unique_ptr<Scene> m_Layer;
+      BlendMode m_LayerMode = BlendMode::srcOver;
+      float m_LayerBounds[4];
+      //Sum of the areas of the run's draws, to bound the layer's empty space.
+      float m_LayerArea = 0.0f;
+      bool m_LayerHasBounds = false;
+
+      float m_MinStrokeWidth = 0.0f;
+      float m_MinDrawSize = 0.0f;
+
+      //Static layers: runs of draws that haven't changed in a while are
+      //rasterized offscreen and replaced by a single picture.
+      bool m_Baking = false;
+      bool m_DrawStable = false;
+      size_t m_DrawSignature = 0;
+      unordered_map<size_t, TvgStableDraw> m_StableDraws;
+      unordered_map<size_t, TvgBakedLayer> m_BakedLayers;
+      size_t m_BakedPixels = 0;
+
+      //Draws of the last frame for pointer queries, indexed on demand.
+      bool m_HitTesting = false;
+      bool m_HitDirty = false;
+      vector<TvgHitRecord> m_HitRecords;
+      TvgHitIndex m_HitIndex;
+
+      TvgStrokeCache* cachedStroke(TvgRenderPath* path, const TvgPaint* paint);
+      void record(Paint* paint, const float* bounds, const float* opaqueRect);
+      void push(unique_ptr<Paint> paint, const float* bounds, const float* opaqueRect);
+      void emit(unique_ptr<Paint> paint, BlendMode mode, const float* bounds, const float* opaqueRect);
+      bool joinsLayer(BlendMode mode, const float* bounds) const;
+      void closeLayer();
+      void commit();
+      void bake();
+      void evictLayers();
+      bool bakeLayer(vector<TvgDrawCommand>::const_iterator first, vector<TvgDrawCommand>::const_iterator last,
+                     TvgBakedLayer& layer);
+      size_t drawSignature(const TvgRenderPath* path, const TvgPaint* paint, const Shape* clip,
+                           const Shape* bgClip);
 
    public:
-      TvgRenderer(Canvas* canvas) : m_Canvas(canvas) {}
+      TvgRenderer(Canvas* canvas, bool retained = false);
+      ~TvgRenderer();
+
+      //Retained mode only: target size used to detect fully covered frames.
+      void viewport(float width, float height);
+      //Retained mode only: starts recording a new frame.
+      void beginFrame();
+      //Retained mode only: drops every paint from the canvas.
+      void reset();
+      //Pushes the recorded frame, call once the artboard is drawn.
+      void flush();
+      //Around each artboard of a frame drawing several: clears the clips so
+      //the artboard's first clipPath() is its background clip again, and
+      //puts back the returned ones after it.
+      TvgClipState resetClips();
+      void restoreClips(const TvgClipState& state);
+      //Quality trade-offs: strokes thinner than minStrokeWidth and draws
+      //smaller than minDrawSize in both directions, in pixels, are skipped.
+      void quality(float minStrokeWidth, float minDrawSize);
+      //Retained mode only: bakes draws that stopped changing into static layers.
+      void layerBaking(bool enabled);
+      //Drops every static layer, they get baked again once things settle.
+      void invalidateLayers();
+      //Retained mode only: records the draws of every frame for hitTest().
+      void hitTesting(bool enabled);
+      //Path of the topmost draw of the last frame covering the canvas point.
+      const RenderPath* hitTest(float x, float y);
+      //Estimated heap of the paint copies of the frames in flight.
+      size_t frameBytes() const { return m_FrameBytes + m_PrevFrameBytes; }
+      //Pixels of the static layers.
+      size_t layerBytes() const { return m_BakedPixels * sizeof(uint32_t); }
+      //Gradients of the paints drawn in the last frame, each paint once.
+      size_t fillBytes() const { return m_FillBytes; }
+
       void save() override;
       void restore() override;
       void transform(const Mat2D& transform) override;
@@ -1,12 +1,27 @@
-#include <fstream>
 #include <vector>
 #include <cstddef>
 #include <algorithm>
-#include <iterator>
+#include <atomic>
+#include <chrono>
+#include <mutex>
 
 #include "rive_tizen.hpp"
+#include "loaded_file.hpp"
+#include "upscale.hpp"
+#include "shapes/shape.hpp"
+#include "shapes/path_composer.hpp"
+#include "shapes/path.hpp"
 using namespace rive_tizen;
 
+// Live controllers, for processMemoryUsage().
+static std::mutex s_ControllersMutex;
+static std::vector<Controller*> s_Controllers;
+
+static double elapsedMilliseconds(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
 void rive_tizen_print()
 {
 	// This line to check calling Rive APIs
@@ -16,50 +31,282 @@ void rive_tizen_print()
 }
 
 
-Controller::Controller() : m_Is_Fileloaded(false), m_File(nullptr) {
+struct rive_tizen::AsyncLoad
+{
+	// Set by the worker once file is final, read by the render thread.
+	std::atomic<bool> ready{false};
+	// Set by the render thread, the worker stops before the next import.
+	std::atomic<bool> cancelled{false};
+	unique_ptr<LoadedFile> file;
+	std::string fileName;
+	std::function<void(bool)> callback;
+};
+
+Controller::Controller() : m_Is_Fileloaded(false), m_Streaming(nullptr), m_ShapesMapped(false),
+	m_NextPlacement(0), m_LayerBaking(false), m_FrameCost(0), m_Reload(false), m_PointersOut(false), m_Visible(true),
+	m_LastRender(std::chrono::steady_clock::now()), m_Artboard(nullptr), m_Buffer(nullptr), m_Width(0), m_Height(0),
+	m_RenderScale(1.0f), m_ScaledWidth(0), m_ScaledHeight(0), m_Upscaler(std::make_unique<Upscaler>()) {
+	std::lock_guard<std::mutex> lock(s_ControllersMutex);
+	s_Controllers.push_back(this);
 }
 
-bool Controller::loadFile(const char* fileName)
+Controller::~Controller()
 {
-	if (m_File != NULL)
 	{
-		delete m_File;
-		m_File = nullptr;
+		std::lock_guard<std::mutex> lock(s_ControllersMutex);
+		s_Controllers.erase(std::find(s_Controllers.begin(), s_Controllers.end(), this));
 	}
+	// A pending load stops on its own and frees itself on the worker.
+	if (m_AsyncLoad)
+	{
+		m_AsyncLoad->cancelled.store(true, std::memory_order_release);
+		if (m_AsyncLoad->ready.load(std::memory_order_acquire) && m_AsyncLoad->file)
+		{
+			LoadedFile::release(std::move(m_AsyncLoad->file));
+		}
+		m_AsyncLoad.reset();
+	}
+	// Unlink the canvas from the cached shapes before the file owning them goes away.
+	m_Renderer.reset();
+	unloadFile();
+}
+
+void Controller::unloadFile()
+{
+	if (m_Renderer)
+	{
+		m_Renderer->reset();
+	}
+	cancelStream();
+	m_File.reset();
+	m_FileName.clear();
+	m_Reload = false;
+	m_PointersOut = false;
+	setArtboard(nullptr);
 	m_Is_Fileloaded = false;
-	m_Canvas->clear();
+}
 
-	std::ifstream fp(fileName, std::ios::binary);
+void Controller::swapFile(unique_ptr<LoadedFile> file)
+{
+	// The canvas must not hold shapes of the old file once it is handed away.
+	if (m_Renderer)
+	{
+		m_Renderer->reset();
+	}
+	auto old = std::move(m_File);
+	m_File = std::move(file);
+	m_FileName.clear();
+	m_Reload = false;
+	m_PointersOut = false;
+	setArtboard(m_File->artboardAt(0));
+	m_Is_Fileloaded = true;
 
-	if (fp.is_open() == false)
+	// Instances may still hold it, the last reference frees it wherever it drops.
+	if (old)
+	{
+		LoadedFile::release(std::move(old));
+	}
+}
+
+bool Controller::loadFile(const char* fileName, bool lazy)
+{
+	cancelAsyncLoad();
+	cancelStream();
+
+	// The current file stays untouched until the new one imported fine.
+	auto file = std::make_unique<LoadedFile>();
+	if (file->load(fileName, lazy, m_CacheDir) == false)
 	{
 		return false;
 	}
+	swapFile(std::move(file));
+	m_FileName = fileName;
+	return true;
+}
 
-	std::vector<uint8_t> binaryData(std::istreambuf_iterator<char>(fp), {});
+void Controller::loadFileAsync(const char* fileName, std::function<void(bool)> callback, bool lazy)
+{
+	cancelAsyncLoad();
+	cancelStream();
 
-	std::size_t length = binaryData.size();
+	auto load = std::make_shared<AsyncLoad>();
+	load->fileName = fileName;
+	load->callback = std::move(callback);
+	m_AsyncLoad = load;
 
-	auto reader = rive::BinaryReader(binaryData.data(), length);
-	auto result = rive::File::import(reader, &m_File);
+	std::string cacheDir = m_CacheDir;
+	LoadedFile::post([load, cacheDir, lazy]() {
+		auto file = std::make_unique<LoadedFile>();
+		if (file->load(load->fileName.c_str(), lazy, cacheDir, &load->cancelled))
+		{
+			load->file = std::move(file);
+		}
+		load->ready.store(true, std::memory_order_release);
+	});
+}
 
-	if (result != rive::ImportResult::success)
+void Controller::cancelAsyncLoad()
+{
+	if (m_AsyncLoad == nullptr)
 	{
-		fprintf(stderr, "failed to import %s\n", fileName);
-		return false;
+		return;
+	}
+	// A queued or running import stops early. One that already finished
+	// is torn down on the worker, like any replaced file.
+	auto load = std::move(m_AsyncLoad);
+	load->cancelled.store(true, std::memory_order_release);
+	if (load->ready.load(std::memory_order_acquire) && load->file)
+	{
+		LoadedFile::release(std::move(load->file));
+	}
+	if (load->callback)
+	{
+		load->callback(false);
 	}
+}
 
-	m_Is_Fileloaded = true;
+void Controller::completeAsyncLoad()
+{
+	if (m_AsyncLoad == nullptr || m_AsyncLoad->ready.load(std::memory_order_acquire) == false)
+	{
+		return;
+	}
+	auto load = std::move(m_AsyncLoad);
+	bool loaded = load->file != nullptr;
+	if (loaded)
+	{
+		swapFile(std::move(load->file));
+		m_FileName = load->fileName;
+	}
+	if (load->callback)
+	{
+		load->callback(loaded);
+	}
+}
+
+bool Controller::beginStream(std::function<void()> drawable)
+{
+	cancelAsyncLoad();
+	cancelStream();
+
+	m_Stream = std::make_unique<LoadedFile>();
+	m_Stream->beginStream();
+	m_Streaming = m_Stream.get();
+	m_StreamDrawable = std::move(drawable);
 	return true;
 }
 
+bool Controller::feed(const uint8_t* bytes, size_t length)
+{
+	if (m_Streaming == nullptr)
+	{
+		return false;
+	}
+	int partial = shownPartial();
+	if (m_Streaming->append(bytes, length) == false)
+	{
+		fprintf(stderr, "malformed stream\n");
+		cancelStream();
+		return false;
+	}
+	streamReady(partial);
+	return true;
+}
+
+bool Controller::endStream()
+{
+	if (m_Streaming == nullptr)
+	{
+		return false;
+	}
+	int partial = shownPartial();
+	bool complete = m_Streaming->finishStream();
+	if (complete)
+	{
+		streamReady(partial);
+	}
+	else
+	{
+		fprintf(stderr, "incomplete stream\n");
+	}
+	// Once swapped in, a stream cut short still shows the artboards it got.
+	m_Stream.reset();
+	m_Streaming = nullptr;
+	m_StreamDrawable = nullptr;
+	return complete;
+}
+
+int Controller::shownPartial()
+{
+	auto artboard = m_Streaming->partialArtboard();
+	return artboard && artboard == m_Artboard ? m_Streaming->partialIndex() : -1;
+}
+
+void Controller::streamReady(int partial)
+{
+	if (m_Stream && m_Stream->readyCount() > 0)
+	{
+		swapFile(std::move(m_Stream));
+	}
+	// Shown without animations until now, switch to the complete import.
+	else if (partial >= 0 && m_Streaming->partialIndex() != partial)
+	{
+		if (m_Renderer)
+		{
+			m_Renderer->reset();
+		}
+		setArtboard(m_Streaming->artboardAt(partial));
+	}
+	else
+	{
+		return;
+	}
+	if (m_StreamDrawable)
+	{
+		m_StreamDrawable();
+	}
+}
+
+void Controller::cancelStream()
+{
+	m_Stream.reset();
+	m_Streaming = nullptr;
+	m_StreamDrawable = nullptr;
+}
+
+void Controller::setInputHandler(std::function<void(const PointerEvent&)> handler)
+{
+	m_InputHandler = std::move(handler);
+}
+
+void Controller::setLayerBaking(bool enabled)
+{
+	m_LayerBaking = enabled;
+	if (m_Renderer)
+	{
+		m_Renderer->layerBaking(enabled);
+	}
+}
+
+void Controller::setCacheDir(const char* path)
+{
+	m_CacheDir = path ? path : "";
+}
+
 bool Controller::setTargetBuffer(uint32_t* buffer, int width, int height)
 {
+	m_Buffer = buffer;
 	m_Width = width;
 	m_Height = height;
+	m_Renderer.reset();
 	m_Canvas = tvg::SwCanvas::gen();
 
 	m_Canvas->target(buffer, width, width, height, tvg::SwCanvas::ARGB8888);
+	m_Renderer = std::make_unique<rive::TvgRenderer>(m_Canvas.get(), true);
+	m_Renderer->layerBaking(m_LayerBaking);
+	// Forces applyScale() to target the canvas and size the viewport.
+	m_ScaledWidth = 0;
+	applyQuality();
 	//TODO: Implements code for setting target buffer
 	return true;
 }
@@ -72,7 +319,7 @@ bool Controller::applyAnimation(char* animationName, bool on)
 
 double Controller::getDuration()
 {
-	auto artboard = getArtboard();
+	auto artboard = m_Artboard;
 	if (artboard == nullptr) {
 		return NAN;
 	}
@@ -91,30 +338,633 @@ tvg::SwCanvas* rive_tizen::Controller::getCanvas() {
 
 bool Controller::render(double elapsed)
 {
-	m_Canvas->clear();
+	auto start = std::chrono::steady_clock::now();
 
-	auto artboard = this->getArtboard();
-	if (artboard == nullptr)
+	// The previous frame is complete, render() and draw() included.
+	if (m_FrameCost > 0 && m_Governor.sample(m_FrameCost))
+	{
+		applyQuality();
+	}
+	m_FrameCost = 0;
+
+	m_LastRender = start;
+
+	// Frame boundary: nothing of the current file is in flight on the canvas.
+	completeAsyncLoad();
+	if (m_Reload)
 	{
+		reloadFile();
+	}
+	// Handlers may queue property writes, they still make it into this frame.
+	m_Input.drain(m_InputHandler);
+	// Queued writes land before advance, so they are part of this frame.
+	// A write changes the signature of the draws it affects, which drops
+	// the static layers holding them in this very frame.
+	m_Properties.apply();
+
+	m_Renderer->beginFrame();
+
+	auto artboard = m_Artboard;
+	if (artboard == nullptr && m_Placements.empty())
+	{
+		m_Renderer->flush();
+		m_FrameCost = elapsedMilliseconds(start);
 		return false;
 	}
+
+	// Placements are laid out in target coordinates, the canvas may be scaled.
+	float scaleX = static_cast<float>(m_ScaledWidth) / m_Width;
+	float scaleY = static_cast<float>(m_ScaledHeight) / m_Height;
+	size_t next = 0;
+	for (; next < m_Placements.size() && m_Placements[next].z < 0; next++)
+	{
+		auto& placement = m_Placements[next];
+		auto& frame = placement.frame;
+		drawArtboard(placement.instance->artboard(),
+			rive::AABB(frame.minX() * scaleX, frame.minY() * scaleY, frame.maxX() * scaleX, frame.maxY() * scaleY),
+			placement.fit, elapsed);
+	}
+	if (artboard)
+	{
+		drawArtboard(artboard, rive::AABB(0, 0, m_ScaledWidth, m_ScaledHeight), rive::Fit::contain, elapsed);
+	}
+	for (; next < m_Placements.size(); next++)
+	{
+		auto& placement = m_Placements[next];
+		auto& frame = placement.frame;
+		drawArtboard(placement.instance->artboard(),
+			rive::AABB(frame.minX() * scaleX, frame.minY() * scaleY, frame.maxX() * scaleX, frame.maxY() * scaleY),
+			placement.fit, elapsed);
+	}
+	m_Renderer->flush();
+
+	m_FrameCost = elapsedMilliseconds(start);
+	return true;
+}
+
+void Controller::drawArtboard(rive::Artboard* artboard, const rive::AABB& frame, rive::Fit fit, double elapsed)
+{
 	artboard->advance(elapsed);
 
-	rive::TvgRenderer renderer(this->getCanvas());
-	renderer.save();
-	renderer.align(rive::Fit::contain,
+	auto renderer = m_Renderer.get();
+	// Each artboard's first clip is its own background clip, not a clip
+	// inside the artboard drawn before it.
+	auto clips = renderer->resetClips();
+	renderer->save();
+	renderer->align(fit,
 		rive::Alignment::center,
-		rive::AABB(0, 0, m_Width, m_Height),
+		frame,
 		artboard->bounds());
-	artboard->draw(&renderer);
-	renderer.restore();
+	artboard->draw(renderer);
+	renderer->restore();
+	renderer->restoreClips(clips);
+}
 
-	return true;
+bool Controller::draw()
+{
+	if (m_Canvas == nullptr)
+	{
+		return false;
+	}
+	auto start = std::chrono::steady_clock::now();
+	bool drawn = m_Canvas->draw() == tvg::Result::Success;
+	if (drawn)
+	{
+		m_Canvas->sync();
+		if (m_ScaledWidth != m_Width || m_ScaledHeight != m_Height)
+		{
+			m_Upscaler->run(m_ScaledBuffer.data(), m_Buffer, m_Width);
+		}
+	}
+	m_FrameCost += elapsedMilliseconds(start);
+	return drawn;
+}
+
+void Controller::setRenderScale(float scale)
+{
+	m_RenderScale = std::min(std::max(scale, 0.01f), 1.0f);
+	applyScale();
+}
+
+int Controller::place(std::unique_ptr<ArtboardInstance> instance, const rive::AABB& frame, int z, rive::Fit fit)
+{
+	if (instance == nullptr)
+	{
+		return -1;
+	}
+	int id = m_NextPlacement++;
+	m_Placements.push_back({id, std::move(instance), frame, z, fit});
+	sortPlacements();
+	return id;
+}
+
+ArtboardInstance* Controller::getPlacement(int id)
+{
+	for (auto& placement : m_Placements)
+	{
+		if (placement.id == id)
+		{
+			return placement.instance.get();
+		}
+	}
+	return nullptr;
+}
+
+bool Controller::movePlacement(int id, const rive::AABB& frame, int z)
+{
+	for (auto& placement : m_Placements)
+	{
+		if (placement.id == id)
+		{
+			placement.frame = frame;
+			placement.z = z;
+			sortPlacements();
+			return true;
+		}
+	}
+	return false;
+}
+
+bool Controller::removePlacement(int id)
+{
+	for (auto itr = m_Placements.begin(); itr != m_Placements.end(); ++itr)
+	{
+		if (itr->id != id)
+		{
+			continue;
+		}
+		// The retained canvas may still hold the instance's shapes.
+		if (m_Renderer)
+		{
+			m_Renderer->reset();
+		}
+		m_Placements.erase(itr);
+		m_ShapesMapped = false;
+		return true;
+	}
+	return false;
+}
+
+void Controller::sortPlacements()
+{
+	std::sort(m_Placements.begin(), m_Placements.end(), [](const Placement& a, const Placement& b) {
+		return a.z != b.z ? a.z < b.z : a.id < b.id;
+	});
+	m_ShapesMapped = false;
+}
+
+MemoryUsage Controller::memoryUsage()
+{
+	MemoryUsage usage;
+	std::unordered_set<const LoadedFile*> files;
+	addUsage(usage, files);
+	return usage;
+}
+
+MemoryUsage Controller::processMemoryUsage()
+{
+	MemoryUsage usage;
+	std::unordered_set<const LoadedFile*> files;
+	{
+		std::lock_guard<std::mutex> lock(s_ControllersMutex);
+		for (auto controller : s_Controllers)
+		{
+			controller->addUsage(usage, files);
+		}
+	}
+	// Pooled geometry once, and gradients whether drawn or not.
+	usage.shapes = rive::TvgMemory::shapes;
+	usage.fills = rive::TvgMemory::fills;
+	return usage;
+}
+
+// Path data of the render paths of an artboard, pooled geometry counted once.
+static void addPathUsage(rive::Artboard* artboard, size_t& shapes,
+	std::unordered_set<const rive::TvgGeometry*>& geometries)
+{
+	auto addPath = [&](rive::RenderPath* path) {
+		if (path == nullptr)
+		{
+			return;
+		}
+		auto renderPath = static_cast<rive::TvgRenderPath*>(path);
+		shapes += renderPath->bytes();
+		auto geometry = renderPath->geometry.get();
+		if (geometry && geometries.insert(geometry).second)
+		{
+			shapes += rive::TvgMemory::shapeBytes(geometry->shape.get());
+		}
+	};
+	for (auto object : artboard->objects())
+	{
+		if (object == nullptr || object->is<rive::Shape>() == false)
+		{
+			continue;
+		}
+		auto shape = object->as<rive::Shape>();
+		addPath(shape->pathComposer()->localPath());
+		addPath(shape->pathComposer()->worldPath());
+		for (auto path : shape->paths())
+		{
+			addPath(path->renderPath());
+		}
+	}
+}
+
+void Controller::addUsage(MemoryUsage& usage, std::unordered_set<const LoadedFile*>& files)
+{
+	auto addFile = [&](LoadedFile* file) {
+		if (file == nullptr || files.insert(file).second == false)
+		{
+			return;
+		}
+		size_t objects, animations, strings;
+		file->usage(objects, animations, strings);
+		usage.fileBytes += file->retainedBytes();
+		usage.objects += objects;
+		usage.animations += animations;
+		usage.strings += strings;
+	};
+	addFile(m_File.get());
+	addFile(m_Stream.get());
+
+	std::unordered_set<const rive::TvgGeometry*> geometries;
+	if (m_Artboard)
+	{
+		addPathUsage(m_Artboard, usage.shapes, geometries);
+	}
+	for (auto& placement : m_Placements)
+	{
+		// The instance's own components, its animations are the file's.
+		addFile(placement.instance->m_Source.get());
+		LoadedFile::artboardUsage(placement.instance->artboard(), usage.objects, usage.strings);
+		addPathUsage(placement.instance->artboard(), usage.shapes, geometries);
+	}
+
+	if (m_Renderer)
+	{
+		usage.fills += m_Renderer->fillBytes();
+		usage.frames += m_Renderer->frameBytes();
+		usage.rasterCaches += m_Renderer->layerBytes();
+	}
+	usage.rasterCaches += m_ScaledBuffer.capacity() * sizeof(uint32_t);
+	if (m_Buffer)
+	{
+		usage.targetBuffers += static_cast<size_t>(m_Width) * m_Height * sizeof(uint32_t);
+	}
+}
+
+void Controller::setVisible(bool visible)
+{
+	m_Visible = visible;
+}
+
+bool Controller::idle() const
+{
+	return m_Visible == false || std::chrono::steady_clock::now() - m_LastRender > std::chrono::seconds(1);
+}
+
+void Controller::trimAllMemory(TrimLevel level)
+{
+	std::lock_guard<std::mutex> lock(s_ControllersMutex);
+	for (auto controller : s_Controllers)
+	{
+		controller->trimMemory(level);
+	}
+}
+
+void Controller::trimMemory(TrimLevel level)
+{
+	if (m_Renderer)
+	{
+		// Unlinks every cached shape from the canvas, the next frame records anew.
+		m_Renderer->reset();
+	}
+	bool pathData = level != TrimLevel::Caches && idle();
+	if (m_Artboard)
+	{
+		trimPaths(m_Artboard, pathData);
+	}
+	for (auto& placement : m_Placements)
+	{
+		trimPaths(placement.instance->artboard(), pathData);
+	}
+
+	// Only a file this controller alone holds, and that never handed out
+	// pointers into it, can be reloaded unnoticed.
+	if (level != TrimLevel::Files || idle() == false || m_FileName.empty() || m_File.use_count() != 1 ||
+		m_PointersOut || m_AsyncLoad || m_Stream)
+	{
+		return;
+	}
+	m_ReloadArtboard = m_Artboard ? m_Artboard->name() : "";
+	m_File.reset();
+	setArtboard(nullptr);
+	m_Reload = true;
+}
+
+void Controller::trimPaths(rive::Artboard* artboard, bool pathData)
+{
+	for (auto object : artboard->objects())
+	{
+		if (object == nullptr || object->is<rive::Shape>() == false)
+		{
+			continue;
+		}
+		auto shape = object->as<rive::Shape>();
+		auto composer = shape->pathComposer();
+		if (composer->localPath())
+		{
+			static_cast<rive::TvgRenderPath*>(composer->localPath())->release(pathData);
+		}
+		if (composer->worldPath())
+		{
+			static_cast<rive::TvgRenderPath*>(composer->worldPath())->release(pathData);
+		}
+		if (pathData == false)
+		{
+			continue;
+		}
+		// Dirty paths rebuild their render paths, and the composer its own,
+		// on the next advance.
+		for (auto path : shape->paths())
+		{
+			static_cast<rive::TvgRenderPath*>(path->renderPath())->release(true);
+			path->markPathDirty();
+		}
+	}
+}
+
+void Controller::reloadFile()
+{
+	m_Reload = false;
+	auto file = std::make_unique<LoadedFile>();
+	if (file->load(m_FileName.c_str(), true, m_CacheDir) == false)
+	{
+		fprintf(stderr, "failed to reload %s\n", m_FileName.c_str());
+		m_FileName.clear();
+		m_Is_Fileloaded = false;
+		return;
+	}
+	m_File = std::move(file);
+	auto artboard = m_File->artboard(m_ReloadArtboard.c_str());
+	setArtboard(artboard ? artboard : m_File->artboardAt(0));
+}
+
+void Controller::setFrameBudget(double milliseconds)
+{
+	m_Governor.budget(milliseconds);
+	applyQuality();
+}
+
+void Controller::applyQuality()
+{
+	if (m_Renderer == nullptr)
+	{
+		return;
+	}
+	switch (m_Governor.tier())
+	{
+		case 0:
+			m_Renderer->quality(0.0f, 0.0f);
+			break;
+		case 1:
+			m_Renderer->quality(1.0f, 0.0f);
+			break;
+		default:
+			m_Renderer->quality(1.0f, 2.0f);
+			break;
+	}
+	applyScale();
+}
+
+void Controller::applyScale()
+{
+	if (m_Renderer == nullptr)
+	{
+		return;
+	}
+	float scale = m_RenderScale;
+	if (m_Governor.tier() >= 3)
+	{
+		scale *= 0.75f;
+	}
+	int width = std::max(1, static_cast<int>(m_Width * scale + 0.5f));
+	int height = std::max(1, static_cast<int>(m_Height * scale + 0.5f));
+	if (width >= m_Width && height >= m_Height)
+	{
+		width = m_Width;
+		height = m_Height;
+	}
+	if (width == m_ScaledWidth && height == m_ScaledHeight)
+	{
+		return;
+	}
+	m_ScaledWidth = width;
+	m_ScaledHeight = height;
+
+	if (width == m_Width && height == m_Height)
+	{
+		m_Canvas->target(m_Buffer, m_Width, m_Width, m_Height, tvg::SwCanvas::ARGB8888);
+	}
+	else
+	{
+		// Grows once to the full target, later scale changes reuse it.
+		if (m_ScaledBuffer.size() < static_cast<size_t>(m_Width) * m_Height)
+		{
+			m_ScaledBuffer.resize(static_cast<size_t>(m_Width) * m_Height);
+		}
+		m_Canvas->target(m_ScaledBuffer.data(), width, width, height, tvg::SwCanvas::ARGB8888);
+		m_Upscaler->setup(width, height, m_Width, m_Height);
+	}
+	// Static layers and the clear-skip are tied to the canvas size.
+	m_Renderer->viewport(width, height);
 }
 rive::Artboard* Controller::getArtboard() {
+	m_PointersOut |= m_Artboard != nullptr;
+	return m_Artboard;
+}
+
+rive::Artboard* Controller::getArtboard(const char* name)
+{
+	auto artboard = m_File ? m_File->artboard(name) : nullptr;
+	m_PointersOut |= artboard != nullptr;
+	return artboard;
+}
+
+rive::Artboard* Controller::getArtboardAt(size_t index)
+{
+	auto artboard = m_File ? m_File->artboardAt(index) : nullptr;
+	m_PointersOut |= artboard != nullptr;
+	return artboard;
+}
+
+size_t Controller::getArtboardCount()
+{
+	return m_File ? m_File->artboardCount() : 0;
+}
+
+bool Controller::selectArtboard(const char* name)
+{
+	auto artboard = m_File ? m_File->artboard(name) : nullptr;
+	if (artboard == nullptr)
+	{
+		return false;
+	}
+	setArtboard(artboard);
+	return true;
+}
+
+bool Controller::selectArtboardAt(size_t index)
+{
+	auto artboard = m_File ? m_File->artboardAt(index) : nullptr;
+	if (artboard == nullptr)
+	{
+		return false;
+	}
+	setArtboard(artboard);
+	return true;
+}
+
+void Controller::setArtboard(rive::Artboard* artboard)
+{
+	m_Artboard = artboard;
+	m_ShapesMapped = false;
+	m_Components.build(artboard);
+}
+
+void Controller::mapShapes()
+{
+	m_PathShapes.clear();
+	m_ShapesMapped = true;
+	if (m_Artboard)
+	{
+		mapShapes(m_Artboard);
+	}
+	for (auto& placement : m_Placements)
+	{
+		mapShapes(placement.instance->artboard());
+	}
+}
+
+void Controller::mapShapes(rive::Artboard* artboard)
+{
+	// A shape draws either its local or its world path, depending on its paints.
+	for (auto object : artboard->objects())
+	{
+		if (object == nullptr || object->is<rive::Shape>() == false)
+		{
+			continue;
+		}
+		auto shape = object->as<rive::Shape>();
+		auto composer = shape->pathComposer();
+		if (composer->localPath())
+		{
+			m_PathShapes[composer->localPath()] = shape;
+		}
+		if (composer->worldPath())
+		{
+			m_PathShapes[composer->worldPath()] = shape;
+		}
+	}
+}
+
+rive::Shape* Controller::hitTest(float x, float y)
+{
+	if (m_Renderer == nullptr)
+	{
+		return nullptr;
+	}
+	m_Renderer->hitTesting(true);
+
+	// Draws are recorded in canvas coordinates, scaled down from the target.
+	auto path = m_Renderer->hitTest(x * m_ScaledWidth / m_Width, y * m_ScaledHeight / m_Height);
+	if (path == nullptr)
+	{
+		return nullptr;
+	}
+	if (m_ShapesMapped == false)
+	{
+		mapShapes();
+	}
+	auto itr = m_PathShapes.find(path);
+	if (itr == m_PathShapes.end())
+	{
+		return nullptr;
+	}
+	m_PointersOut = true;
+	return itr->second;
+}
+
+std::unique_ptr<ArtboardInstance> Controller::createInstance(const char* name)
+{
 	if (m_File == nullptr)
 	{
 		return nullptr;
 	}
-	return m_File->artboard();
-}
\ No newline at end of file
+	int index = m_File->find(name);
+	if (index < 0)
+	{
+		return nullptr;
+	}
+	return createInstanceAt(index);
+}
+
+std::unique_ptr<ArtboardInstance> Controller::createInstanceAt(size_t index)
+{
+	if (m_File == nullptr)
+	{
+		return nullptr;
+	}
+	auto sourceArtboard = m_File->artboardAt(index);
+	size_t importedBytes;
+	auto file = m_File->importInstance(index, importedBytes);
+	if (sourceArtboard == nullptr || file == nullptr)
+	{
+		delete file;
+		return nullptr;
+	}
+	return std::unique_ptr<ArtboardInstance>(new ArtboardInstance(m_File, index, file, importedBytes));
+}
+
+ArtboardInstance::ArtboardInstance(std::shared_ptr<LoadedFile> source, size_t sourceIndex,
+	rive::File* file, size_t importedBytes) : m_Source(std::move(source)),
+	m_SourceIndex(sourceIndex), m_File(file), m_Artboard(file->artboard()),
+	m_ImportedBytes(importedBytes)
+{
+	m_Artboard->advance(0.0f);
+}
+
+ArtboardInstance::~ArtboardInstance()
+{
+}
+
+MemoryUsage ArtboardInstance::memoryUsage() const
+{
+	MemoryUsage usage;
+	LoadedFile::artboardUsage(m_Artboard, usage.objects, usage.strings);
+	std::unordered_set<const rive::TvgGeometry*> geometries;
+	addPathUsage(m_Artboard, usage.shapes, geometries);
+	return usage;
+}
+
+rive::Artboard* ArtboardInstance::animationSource() const
+{
+	// Looked up each time, a streamed artboard gets its animations late.
+	return m_Source->artboardAt(m_SourceIndex);
+}
+
+size_t ArtboardInstance::animationCount() const
+{
+	return animationSource()->animationCount();
+}
+
+rive::LinearAnimation* ArtboardInstance::animation(size_t index) const
+{
+	return animationSource()->animation(index);
+}
+
+rive::LinearAnimation* ArtboardInstance::animation(const char* name) const
+{
+	return animationSource()->animation(name);
+}
@@ -0,0 +1,166 @@
+#include <algorithm>
+
+#include "upscale.hpp"
+
+#if defined(__SSE2__)
+	#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#include <arm_neon.h>
+	#define RIVE_TIZEN_NEON
+#endif
+
+using namespace rive_tizen;
+
+// 7 bit weights keep a * (128 - w) + b * w inside 16 bits for every channel.
+static const int WeightBits = 7;
+static const int WeightOne = 1 << WeightBits;
+
+// Source sample positions for each destination position, pixel centers aligned.
+static void sampleTable(int src, int dst, std::vector<int32_t>& index, std::vector<uint16_t>& weight)
+{
+	index.resize(dst);
+	weight.resize(dst);
+	float step = static_cast<float>(src) / dst;
+	for (int i = 0; i < dst; i++)
+	{
+		float position = (i + 0.5f) * step - 0.5f;
+		if (position < 0)
+		{
+			position = 0;
+		}
+		int first = static_cast<int>(position);
+		if (first >= src - 1)
+		{
+			index[i] = src - 1;
+			weight[i] = 0;
+			continue;
+		}
+		index[i] = first;
+		weight[i] = static_cast<uint16_t>((position - first) * WeightOne + 0.5f);
+	}
+}
+
+void Upscaler::setup(int srcWidth, int srcHeight, int dstWidth, int dstHeight)
+{
+	if (srcWidth == m_SrcWidth && srcHeight == m_SrcHeight && dstWidth == m_DstWidth && dstHeight == m_DstHeight)
+	{
+		return;
+	}
+	m_SrcWidth = srcWidth;
+	m_SrcHeight = srcHeight;
+	m_DstWidth = dstWidth;
+	m_DstHeight = dstHeight;
+
+	// The tables only depend on the target size, vectors keep their capacity.
+	sampleTable(srcWidth, dstWidth, m_Columns, m_ColumnWeights);
+	sampleTable(srcHeight, dstHeight, m_Rows, m_RowWeights);
+	// One spare pixel lets the horizontal pass read x + 1 unconditionally.
+	m_Row.resize(dstWidth + 1);
+}
+
+static inline uint32_t blendScalar(uint32_t a, uint32_t b, uint32_t weight)
+{
+	uint32_t inverse = WeightOne - weight;
+	uint32_t rb = ((a & 0x00ff00ff) * inverse + (b & 0x00ff00ff) * weight + 0x00400040) >> WeightBits;
+	uint32_t ag = (((a >> 8) & 0x00ff00ff) * inverse + ((b >> 8) & 0x00ff00ff) * weight + 0x00400040) >> WeightBits;
+	return (rb & 0x00ff00ff) | ((ag & 0x00ff00ff) << 8);
+}
+
+// Vertical pass: row = top * (1 - w) + bottom * w.
+static void blendRows(const uint32_t* top, const uint32_t* bottom, uint32_t* row, int count, uint16_t weight)
+{
+	int i = 0;
+	if (weight == 0)
+	{
+		std::copy(top, top + count, row);
+		return;
+	}
+#if defined(__SSE2__)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i w = _mm_set1_epi16(weight);
+	const __m128i inverse = _mm_set1_epi16(WeightOne - weight);
+	const __m128i round = _mm_set1_epi16(WeightOne / 2);
+	for (; i + 4 <= count; i += 4)
+	{
+		__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(top + i));
+		__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bottom + i));
+		__m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), inverse),
+			_mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), w));
+		__m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), inverse),
+			_mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), w));
+		lo = _mm_srli_epi16(_mm_add_epi16(lo, round), WeightBits);
+		hi = _mm_srli_epi16(_mm_add_epi16(hi, round), WeightBits);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(row + i), _mm_packus_epi16(lo, hi));
+	}
+#elif defined(RIVE_TIZEN_NEON)
+	const uint8x8_t w = vdup_n_u8(static_cast<uint8_t>(weight));
+	const uint8x8_t inverse = vdup_n_u8(static_cast<uint8_t>(WeightOne - weight));
+	for (; i + 4 <= count; i += 4)
+	{
+		uint8x16_t a = vreinterpretq_u8_u32(vld1q_u32(top + i));
+		uint8x16_t b = vreinterpretq_u8_u32(vld1q_u32(bottom + i));
+		uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(a), inverse), vget_low_u8(b), w);
+		uint16x8_t hi = vmlal_u8(vmull_u8(vget_high_u8(a), inverse), vget_high_u8(b), w);
+		uint8x16_t result = vcombine_u8(vrshrn_n_u16(lo, WeightBits), vrshrn_n_u16(hi, WeightBits));
+		vst1q_u32(row + i, vreinterpretq_u32_u8(result));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		row[i] = blendScalar(top[i], bottom[i], weight);
+	}
+}
+
+// Horizontal pass: dst[x] = row[c] * (1 - w) + row[c + 1] * w.
+static void stretchRow(const uint32_t* row, const int32_t* columns, const uint16_t* weights, uint32_t* dst, int count)
+{
+	int i = 0;
+#if defined(__SSE2__)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i round = _mm_set1_epi16(WeightOne / 2);
+	for (; i + 2 <= count; i += 2)
+	{
+		// Two destination pixels per register, one in each half.
+		__m128i a = _mm_unpacklo_epi32(_mm_cvtsi32_si128(row[columns[i]]), _mm_cvtsi32_si128(row[columns[i + 1]]));
+		__m128i b = _mm_unpacklo_epi32(_mm_cvtsi32_si128(row[columns[i] + 1]),
+			_mm_cvtsi32_si128(row[columns[i + 1] + 1]));
+		__m128i w = _mm_unpacklo_epi64(_mm_set1_epi16(weights[i]), _mm_set1_epi16(weights[i + 1]));
+		__m128i inverse = _mm_sub_epi16(_mm_set1_epi16(WeightOne), w);
+		__m128i sum = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), inverse),
+			_mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), w));
+		sum = _mm_srli_epi16(_mm_add_epi16(sum, round), WeightBits);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(sum, zero));
+	}
+#elif defined(RIVE_TIZEN_NEON)
+	for (; i + 2 <= count; i += 2)
+	{
+		uint32x2_t pa = vset_lane_u32(row[columns[i + 1]], vdup_n_u32(row[columns[i]]), 1);
+		uint32x2_t pb = vset_lane_u32(row[columns[i + 1] + 1], vdup_n_u32(row[columns[i] + 1]), 1);
+		uint8x8_t w = vreinterpret_u8_u32(vset_lane_u32(weights[i + 1] * 0x01010101u,
+			vdup_n_u32(weights[i] * 0x01010101u), 1));
+		uint8x8_t inverse = vsub_u8(vdup_n_u8(WeightOne), w);
+		uint16x8_t sum = vmlal_u8(vmull_u8(vreinterpret_u8_u32(pa), inverse), vreinterpret_u8_u32(pb), w);
+		vst1_u32(dst + i, vreinterpret_u32_u8(vrshrn_n_u16(sum, WeightBits)));
+	}
+#endif
+	for (; i < count; i++)
+	{
+		dst[i] = blendScalar(row[columns[i]], row[columns[i] + 1], weights[i]);
+	}
+}
+
+void Upscaler::run(const uint32_t* src, uint32_t* dst, int dstStride)
+{
+	int lastRow = m_SrcHeight - 1;
+	for (int y = 0; y < m_DstHeight; y++)
+	{
+		int first = m_Rows[y];
+		const uint32_t* top = src + static_cast<size_t>(first) * m_SrcWidth;
+		const uint32_t* bottom = src + static_cast<size_t>(std::min(first + 1, lastRow)) * m_SrcWidth;
+		blendRows(top, bottom, m_Row.data(), m_SrcWidth, m_RowWeights[y]);
+		// Columns at the right edge have weight 0, their x + 1 reads the spare pixel.
+		m_Row[m_SrcWidth] = m_Row[m_SrcWidth - 1];
+		stretchRow(m_Row.data(), m_Columns.data(), m_ColumnWeights.data(), dst + static_cast<size_t>(y) * dstStride,
+			m_DstWidth);
+	}
+}
@@ -0,0 +1,36 @@
+#ifndef _RIVE_TIZEN_UPSCALE_HPP_
+#define _RIVE_TIZEN_UPSCALE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rive_tizen
+{
+	// Bilinear upscaler for premultiplied 32 bit pixels. Sampling tables and
+	// the row buffer are sized for the largest target once, so changing the
+	// source size never reallocates.
+	class Upscaler
+	{
+	public:
+		// Prepares the tables for scaling srcWidth x srcHeight up to
+		// dstWidth x dstHeight.
+		void setup(int srcWidth, int srcHeight, int dstWidth, int dstHeight);
+		void run(const uint32_t* src, uint32_t* dst, int dstStride);
+
+	private:
+		int m_SrcWidth = 0;
+		int m_SrcHeight = 0;
+		int m_DstWidth = 0;
+		int m_DstHeight = 0;
+		// Per destination column and row: the first source sample and the
+		// weight of the second one, in 1/128 steps.
+		std::vector<int32_t> m_Columns;
+		std::vector<uint16_t> m_ColumnWeights;
+		std::vector<int32_t> m_Rows;
+		std::vector<uint16_t> m_RowWeights;
+		std::vector<uint32_t> m_Row;
+	};
+}
+
+#endif
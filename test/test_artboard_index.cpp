@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "artboard_index.hpp"
+#include "loaded_file.hpp"
+#include "generated/artboard_base.hpp"
+#include "generated/component_base.hpp"
+#include "generated/animation/linear_animation_base.hpp"
+#include "generated/animation/keyed_object_base.hpp"
+#include "generated/animation/keyed_property_base.hpp"
+#include "generated/animation/keyframe_double_base.hpp"
+#include "generated/animation/keyframe_color_base.hpp"
+
+using namespace rive_tizen;
+
+// Properties declared in the ToC of the test files, unknown to the registry.
+static const uint64_t UintKey = 9000;
+static const uint64_t DoubleKey = 9001;
+
+static void putVarUint(std::vector<uint8_t>& bytes, uint64_t value)
+{
+    do
+    {
+        uint8_t byte = value & 0x7f;
+        value >>= 7;
+        bytes.push_back(value ? byte | 0x80 : byte);
+    } while (value);
+}
+
+static void putString(std::vector<uint8_t>& bytes, uint64_t key, const std::string& value)
+{
+    putVarUint(bytes, key);
+    putVarUint(bytes, value.size());
+    bytes.insert(bytes.end(), value.begin(), value.end());
+}
+
+static std::vector<uint8_t> header()
+{
+    std::vector<uint8_t> bytes = {'R', 'I', 'V', 'E'};
+    putVarUint(bytes, 7);
+    putVarUint(bytes, 0);
+    putVarUint(bytes, 0);
+    putVarUint(bytes, UintKey);
+    putVarUint(bytes, DoubleKey);
+    putVarUint(bytes, 0);
+    // Field types, 2 bits per key: uint (0) then double (2).
+    bytes.insert(bytes.end(), {0x08, 0, 0, 0});
+    return bytes;
+}
+
+static void putArtboard(std::vector<uint8_t>& bytes, const std::string& name)
+{
+    putVarUint(bytes, rive::ArtboardBase::typeKey);
+    putString(bytes, rive::ComponentBase::namePropertyKey, name);
+    putVarUint(bytes, DoubleKey);
+    bytes.insert(bytes.end(), {0, 0, 0x80, 0x3f});
+    putVarUint(bytes, 0);
+}
+
+static void putObject(std::vector<uint8_t>& bytes, uint64_t typeKey)
+{
+    putVarUint(bytes, typeKey);
+    putVarUint(bytes, UintKey);
+    putVarUint(bytes, 300);
+    putVarUint(bytes, 0);
+}
+
+static std::vector<uint8_t> twoArtboards()
+{
+    auto bytes = header();
+    putArtboard(bytes, "first");
+    putObject(bytes, 2);
+    putObject(bytes, rive::LinearAnimationBase::typeKey);
+    putArtboard(bytes, "second");
+    putObject(bytes, 2);
+    return bytes;
+}
+
+TEST(ArtboardIndexTest, IndexesArtboards)
+{
+    auto bytes = twoArtboards();
+    ArtboardIndex index;
+    ASSERT_TRUE(index.scan(bytes.data(), bytes.size()));
+    index.finish(bytes.size());
+
+    ASSERT_EQ(index.count(), 2u);
+    EXPECT_EQ(index.completeCount(), 2u);
+    EXPECT_EQ(index.at(0).name, "first");
+    EXPECT_EQ(index.at(1).name, "second");
+    EXPECT_EQ(index.at(0).end, index.at(1).start);
+    EXPECT_EQ(index.at(1).end, bytes.size());
+    EXPECT_GT(index.at(0).animationStart, index.at(0).start);
+    EXPECT_EQ(index.at(1).animationStart, 0u);
+    EXPECT_EQ(index.find("second"), 1);
+    EXPECT_EQ(index.find("third"), -1);
+}
+
+TEST(ArtboardIndexTest, CountsAnimationObjects)
+{
+    auto bytes = header();
+    putArtboard(bytes, "first");
+    putObject(bytes, 2);
+    putObject(bytes, rive::LinearAnimationBase::typeKey);
+    putObject(bytes, rive::KeyedObjectBase::typeKey);
+    putObject(bytes, rive::KeyedPropertyBase::typeKey);
+    putObject(bytes, rive::KeyFrameDoubleBase::typeKey);
+    putObject(bytes, rive::KeyFrameDoubleBase::typeKey);
+    putObject(bytes, rive::KeyedPropertyBase::typeKey);
+    putObject(bytes, rive::KeyFrameColorBase::typeKey);
+    putObject(bytes, rive::LinearAnimationBase::typeKey);
+    putArtboard(bytes, "second");
+    putObject(bytes, 2);
+
+    ArtboardIndex index;
+    ASSERT_TRUE(index.scan(bytes.data(), bytes.size()));
+    index.finish(bytes.size());
+
+    ASSERT_EQ(index.count(), 2u);
+    EXPECT_EQ(index.at(0).animations, 2u);
+    EXPECT_EQ(index.at(0).keyedObjects, 1u);
+    EXPECT_EQ(index.at(0).keyedProperties, 2u);
+    EXPECT_EQ(index.at(0).keyFrames, 3u);
+    EXPECT_EQ(index.at(1).animations, 0u);
+    EXPECT_EQ(index.at(1).keyFrames, 0u);
+}
+
+TEST(ArtboardIndexTest, ChunkedScanMatchesWholeScan)
+{
+    auto bytes = twoArtboards();
+    ArtboardIndex index;
+    for (size_t length = 0; length <= bytes.size(); length++)
+    {
+        ASSERT_TRUE(index.scan(bytes.data(), length));
+        EXPECT_LE(index.scanned(), length);
+    }
+    index.finish(bytes.size());
+
+    ASSERT_EQ(index.count(), 2u);
+    EXPECT_EQ(index.at(1).start, index.at(0).end);
+    EXPECT_EQ(index.at(1).end, bytes.size());
+}
+
+TEST(ArtboardIndexTest, WaitsForTruncatedInput)
+{
+    auto bytes = twoArtboards();
+    ArtboardIndex index;
+
+    // Not even the magic.
+    ASSERT_TRUE(index.scan(bytes.data(), 3));
+    EXPECT_FALSE(index.headerRead());
+
+    // Cut inside the second artboard's name: only the first one is complete.
+    size_t cut = bytes.size() - 8;
+    ASSERT_TRUE(index.scan(bytes.data(), cut));
+    EXPECT_EQ(index.count(), 1u);
+    EXPECT_EQ(index.completeCount(), 0u);
+    EXPECT_LE(index.scanned(), cut);
+}
+
+TEST(ArtboardIndexTest, RejectsBadMagic)
+{
+    auto bytes = twoArtboards();
+    bytes[0] = 'X';
+    ArtboardIndex index;
+    EXPECT_FALSE(index.scan(bytes.data(), bytes.size()));
+}
+
+TEST(ArtboardIndexTest, RejectsUnknownProperty)
+{
+    auto bytes = header();
+    putVarUint(bytes, rive::ArtboardBase::typeKey);
+    putVarUint(bytes, 9999);
+    putVarUint(bytes, 0);
+    ArtboardIndex index;
+    EXPECT_FALSE(index.scan(bytes.data(), bytes.size()));
+}
+
+TEST(ArtboardIndexTest, HugeStringLengthDoesNotWrap)
+{
+    auto bytes = header();
+    size_t start = bytes.size();
+    putVarUint(bytes, rive::ArtboardBase::typeKey);
+    putVarUint(bytes, rive::ComponentBase::namePropertyKey);
+    putVarUint(bytes, UINT64_MAX - 2);
+    bytes.insert(bytes.end(), 16, 'a');
+
+    ArtboardIndex index;
+    ASSERT_TRUE(index.scan(bytes.data(), bytes.size()));
+    // The object never completes, the scan must neither move back nor skip ahead.
+    EXPECT_EQ(index.scanned(), start);
+    EXPECT_EQ(index.count(), 0u);
+}
+
+TEST(ArtboardIndexTest, FileWithoutArtboardsFailsInBothModes)
+{
+    auto bytes = header();
+    auto path = testing::TempDir() + "no_artboards.riv";
+    FILE* file = fopen(path.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    fwrite(bytes.data(), 1, bytes.size(), file);
+    fclose(file);
+
+    LoadedFile eager;
+    EXPECT_FALSE(eager.load(path.c_str(), false, ""));
+    LoadedFile lazy;
+    EXPECT_FALSE(lazy.load(path.c_str(), true, ""));
+    remove(path.c_str());
+}
@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <vector>
+
+#include "tvg_renderer.hpp"
+#include "tvg_hit_index.hpp"
+
+using namespace rive;
+
+static const Matrix Identity = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+
+class HitIndexTest : public ::testing::Test {
+public:
+    void SetUp() {
+        // Only compared by the index, any distinct addresses will do.
+        paths.resize(256);
+    }
+
+    // Draw of a path space rect moved by (dx, dy).
+    void addRect(float x, float y, float w, float h, float dx = 0, float dy = 0, float thickness = 0) {
+        auto geometry = make_shared<TvgGeometry>();
+        geometry->shape = Shape::gen();
+        geometry->shape->appendRect(x, y, w, h, 0, 0);
+        add(geometry, x + dx, y + dy, x + w + dx, y + h + dy, dx, dy, thickness);
+    }
+
+    void add(shared_ptr<TvgGeometry> geometry, float minX, float minY, float maxX, float maxY,
+        float dx = 0, float dy = 0, float thickness = 0) {
+        TvgHitRecord record;
+        record.path = reinterpret_cast<const RenderPath*>(&paths[records.size()]);
+        record.geometry = std::move(geometry);
+        record.transform = Identity;
+        record.transform.e13 = dx;
+        record.transform.e23 = dy;
+        float reach = thickness * 0.5f;
+        record.bounds[0] = minX - reach;
+        record.bounds[1] = minY - reach;
+        record.bounds[2] = maxX + reach;
+        record.bounds[3] = maxY + reach;
+        record.thickness = thickness;
+        records.push_back(std::move(record));
+    }
+
+    // Topmost hit by testing every record, what the tree must agree with.
+    int linearQuery(float x, float y) {
+        for (int i = static_cast<int>(records.size()) - 1; i >= 0; i--) {
+            auto& bounds = records[i].bounds;
+            if (x >= bounds[0] && x <= bounds[2] && y >= bounds[1] && y <= bounds[3] && hitPath(records[i], x, y)) {
+                return i;
+            }
+        }
+        return -1;
+    }
+public:
+    std::vector<char> paths;
+    std::vector<TvgHitRecord> records;
+    TvgHitIndex index;
+};
+
+TEST_F(HitIndexTest, EmptyIndexFindsNothing) {
+    EXPECT_EQ(index.query(records, 0, 0), -1);
+    index.update(records);
+    EXPECT_EQ(index.query(records, 0, 0), -1);
+}
+
+TEST_F(HitIndexTest, TopmostDrawWins) {
+    addRect(0, 0, 10, 10);
+    addRect(5, 5, 10, 10);
+    index.update(records);
+
+    EXPECT_EQ(index.query(records, 7, 7), 1);
+    EXPECT_EQ(index.query(records, 2, 2), 0);
+    EXPECT_EQ(index.query(records, 20, 20), -1);
+}
+
+TEST_F(HitIndexTest, TestsThePathNotItsBounds) {
+    auto geometry = make_shared<TvgGeometry>();
+    geometry->shape = Shape::gen();
+    geometry->shape->moveTo(0, 0);
+    geometry->shape->lineTo(10, 0);
+    geometry->shape->lineTo(0, 10);
+    geometry->shape->close();
+    add(geometry, 0, 0, 10, 10);
+    index.update(records);
+
+    EXPECT_EQ(index.query(records, 2, 2), 0);
+    // Inside the bounds, across the diagonal.
+    EXPECT_EQ(index.query(records, 8, 8), -1);
+}
+
+TEST_F(HitIndexTest, StrokesHitAlongTheirOutline) {
+    addRect(0, 0, 20, 20, 0, 0, 4);
+    index.update(records);
+
+    EXPECT_EQ(index.query(records, 1, 10), 0);
+    EXPECT_EQ(index.query(records, -1.5f, 10), 0);
+    // The inside of a stroked shape isn't part of the stroke.
+    EXPECT_EQ(index.query(records, 10, 10), -1);
+}
+
+TEST_F(HitIndexTest, AppliesTheDrawTransform) {
+    addRect(0, 0, 10, 10, 100, 50);
+    index.update(records);
+
+    EXPECT_EQ(index.query(records, 105, 55), 0);
+    EXPECT_EQ(index.query(records, 5, 5), -1);
+}
+
+TEST_F(HitIndexTest, MatchesALinearScan) {
+    srand(3);
+    for (int i = 0; i < 200; i++) {
+        addRect(rand() % 500, rand() % 500, 5 + rand() % 60, 5 + rand() % 60);
+    }
+    index.update(records);
+
+    for (int i = 0; i < 2000; i++) {
+        float x = rand() % 580 - 10 + 0.5f;
+        float y = rand() % 580 - 10 + 0.5f;
+        ASSERT_EQ(index.query(records, x, y), linearQuery(x, y)) << "at " << x << "," << y;
+    }
+}
+
+TEST_F(HitIndexTest, RefitsDrawsThatMoved) {
+    for (int i = 0; i < 40; i++) {
+        addRect(i * 20, 0, 10, 10);
+    }
+    index.update(records);
+    EXPECT_EQ(index.query(records, 5, 5), 0);
+
+    // Same paths in the same order, moved down: the tree is refitted.
+    for (auto& record : records) {
+        record.transform.e23 = 100;
+        record.bounds[1] += 100;
+        record.bounds[3] += 100;
+    }
+    index.update(records);
+    EXPECT_EQ(index.query(records, 5, 5), -1);
+    EXPECT_EQ(index.query(records, 5, 105), 0);
+    EXPECT_EQ(index.query(records, 785, 105), 39);
+}
+
+TEST_F(HitIndexTest, RebuildsWhenTheDrawsChange) {
+    addRect(0, 0, 10, 10);
+    index.update(records);
+
+    records.clear();
+    addRect(50, 50, 10, 10);
+    addRect(0, 0, 10, 10);
+    index.update(records);
+    EXPECT_EQ(index.query(records, 55, 55), 0);
+    EXPECT_EQ(index.query(records, 5, 5), 1);
+}
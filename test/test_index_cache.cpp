@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "artboard_index.hpp"
+#include "index_cache.hpp"
+#include "mapped_file.hpp"
+
+using namespace rive_tizen;
+
+class IndexCacheTest : public ::testing::Test {
+public:
+    void SetUp() {
+        path = testing::TempDir() + "index_cache_test.rtzi";
+        stamp.size = 4096;
+        stamp.modifiedSeconds = 1700000000;
+        stamp.inode = 42;
+        std::vector<ArtboardRange> artboards = {{"first", 100, 1000, 600, 2, 3, 4, 50}, {"first", 1000, 4096, 0}};
+        ASSERT_TRUE(index.restore(20, artboards));
+    }
+    void TearDown() {
+        remove(path.c_str());
+    }
+public:
+    std::string path;
+    FileStamp stamp;
+    ArtboardIndex index;
+};
+
+TEST_F(IndexCacheTest, RoundTrips) {
+    ASSERT_TRUE(IndexCache::write(path.c_str(), stamp, index));
+
+    ArtboardIndex restored;
+    ASSERT_TRUE(IndexCache::read(path.c_str(), stamp, restored));
+    ASSERT_EQ(restored.count(), 2u);
+    EXPECT_EQ(restored.completeCount(), 2u);
+    EXPECT_EQ(restored.headerEnd(), 20u);
+    for (size_t i = 0; i < 2; i++) {
+        EXPECT_EQ(restored.at(i).name, index.at(i).name);
+        EXPECT_EQ(restored.at(i).start, index.at(i).start);
+        EXPECT_EQ(restored.at(i).end, index.at(i).end);
+        EXPECT_EQ(restored.at(i).animationStart, index.at(i).animationStart);
+        EXPECT_EQ(restored.at(i).animations, index.at(i).animations);
+        EXPECT_EQ(restored.at(i).keyedObjects, index.at(i).keyedObjects);
+        EXPECT_EQ(restored.at(i).keyedProperties, index.at(i).keyedProperties);
+        EXPECT_EQ(restored.at(i).keyFrames, index.at(i).keyFrames);
+    }
+}
+
+TEST_F(IndexCacheTest, RejectsChangedSource) {
+    ASSERT_TRUE(IndexCache::write(path.c_str(), stamp, index));
+
+    FileStamp touched = stamp;
+    touched.modifiedNanoseconds = 1;
+    ArtboardIndex restored;
+    EXPECT_FALSE(IndexCache::read(path.c_str(), touched, restored));
+}
+
+TEST_F(IndexCacheTest, RejectsCorruptedPayload) {
+    ASSERT_TRUE(IndexCache::write(path.c_str(), stamp, index));
+
+    // Flip a byte of the last artboard name, past the header.
+    FILE* fp = fopen(path.c_str(), "r+b");
+    ASSERT_NE(fp, nullptr);
+    fseek(fp, -1, SEEK_END);
+    int byte = fgetc(fp);
+    fseek(fp, -1, SEEK_END);
+    fputc(byte ^ 0xff, fp);
+    fclose(fp);
+
+    ArtboardIndex restored;
+    EXPECT_FALSE(IndexCache::read(path.c_str(), stamp, restored));
+}
+
+TEST_F(IndexCacheTest, RejectsSizeOtherThanTheHeaderTells) {
+    ASSERT_TRUE(IndexCache::write(path.c_str(), stamp, index));
+
+    // The payload checks out, the file holds more than it.
+    FILE* fp = fopen(path.c_str(), "ab");
+    ASSERT_NE(fp, nullptr);
+    fputc(0, fp);
+    fclose(fp);
+
+    ArtboardIndex restored;
+    EXPECT_FALSE(IndexCache::read(path.c_str(), stamp, restored));
+}
+
+TEST_F(IndexCacheTest, RejectsMissingFile) {
+    ArtboardIndex restored;
+    EXPECT_FALSE(IndexCache::read(path.c_str(), stamp, restored));
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "rive_tizen.hpp"
+
+using namespace rive_tizen;
+
+class InputQueueTest : public ::testing::Test {
+public:
+    std::vector<PointerEvent> drain() {
+        std::vector<PointerEvent> events;
+        queue.drain([&events](const PointerEvent& event) { events.push_back(event); });
+        return events;
+    }
+public:
+    InputQueue queue;
+};
+
+TEST_F(InputQueueTest, CoalescesRunsOfMoves) {
+    queue.push(PointerEvent::Type::move, 1, 1);
+    queue.push(PointerEvent::Type::move, 2, 2);
+    queue.push(PointerEvent::Type::down, 3, 3);
+    queue.push(PointerEvent::Type::move, 4, 4);
+    queue.push(PointerEvent::Type::move, 5, 5);
+    queue.push(PointerEvent::Type::move, 6, 6);
+    queue.push(PointerEvent::Type::up, 7, 7);
+
+    auto events = drain();
+    ASSERT_EQ(events.size(), 4u);
+    EXPECT_EQ(events[0].type, PointerEvent::Type::move);
+    EXPECT_EQ(events[0].x, 2);
+    EXPECT_EQ(events[1].type, PointerEvent::Type::down);
+    EXPECT_EQ(events[2].type, PointerEvent::Type::move);
+    EXPECT_EQ(events[2].x, 6);
+    EXPECT_EQ(events[3].type, PointerEvent::Type::up);
+}
+
+TEST_F(InputQueueTest, KeepsTheLastMoveOfAFrame) {
+    queue.push(PointerEvent::Type::move, 1, 1);
+    queue.push(PointerEvent::Type::move, 2, 2);
+
+    auto events = drain();
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].x, 2);
+    EXPECT_EQ(events[0].y, 2);
+    EXPECT_TRUE(drain().empty());
+}
+
+TEST_F(InputQueueTest, ReservesTheLastSlotForDownAndUp) {
+    for (size_t i = 0; i < InputQueue::Capacity - 1; i++) {
+        ASSERT_TRUE(queue.push(PointerEvent::Type::move, i, 0));
+    }
+    // Kept aside instead of taking the last slot.
+    EXPECT_TRUE(queue.push(PointerEvent::Type::move, 1000, 0));
+    EXPECT_TRUE(queue.push(PointerEvent::Type::up, 0, 0));
+    EXPECT_FALSE(queue.push(PointerEvent::Type::down, 0, 0));
+
+    auto events = drain();
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].type, PointerEvent::Type::move);
+    EXPECT_EQ(events[0].x, 1000);
+    EXPECT_EQ(events[1].type, PointerEvent::Type::up);
+}
+
+TEST_F(InputQueueTest, KeepsTheFreshestMoveWhenFull) {
+    for (size_t i = 0; i < InputQueue::Capacity; i++) {
+        ASSERT_TRUE(queue.push(i ? PointerEvent::Type::move : PointerEvent::Type::down, i, 0));
+    }
+    EXPECT_TRUE(queue.push(PointerEvent::Type::move, 1000, 1));
+    EXPECT_TRUE(queue.push(PointerEvent::Type::move, 1001, 2));
+
+    auto events = drain();
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].type, PointerEvent::Type::down);
+    EXPECT_EQ(events[1].x, 1001);
+    EXPECT_EQ(events[1].y, 2);
+
+    // Delivered once, later moves go through the queue again.
+    ASSERT_TRUE(queue.push(PointerEvent::Type::move, 5, 5));
+    events = drain();
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].x, 5);
+    EXPECT_TRUE(drain().empty());
+}
+
+TEST_F(InputQueueTest, OverflowMoveGoesBeforeLaterEvents) {
+    for (size_t i = 0; i < InputQueue::Capacity - 1; i++) {
+        ASSERT_TRUE(queue.push(PointerEvent::Type::down, i, 0));
+    }
+    EXPECT_TRUE(queue.push(PointerEvent::Type::move, 1000, 0));
+    EXPECT_TRUE(queue.push(PointerEvent::Type::up, 2000, 0));
+
+    auto events = drain();
+    ASSERT_EQ(events.size(), InputQueue::Capacity + 1);
+    EXPECT_EQ(events[InputQueue::Capacity - 1].x, 1000);
+    EXPECT_EQ(events[InputQueue::Capacity].x, 2000);
+}
+
+TEST_F(InputQueueTest, WrapsAround) {
+    for (size_t round = 0; round < 3; round++) {
+        for (size_t i = 0; i < InputQueue::Capacity / 2; i++) {
+            ASSERT_TRUE(queue.push(i % 2 ? PointerEvent::Type::up : PointerEvent::Type::down, i, round));
+        }
+        auto events = drain();
+        ASSERT_EQ(events.size(), InputQueue::Capacity / 2);
+        EXPECT_EQ(events.back().x, InputQueue::Capacity / 2 - 1);
+        EXPECT_EQ(events.back().y, round);
+    }
+}
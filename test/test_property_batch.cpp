@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include "rive_tizen.hpp"
+#include "node.hpp"
+
+using namespace rive_tizen;
+
+// A node outside any artboard, counting the changes instead of dirtying it.
+class ProbeNode : public rive::Node {
+public:
+    int changes = 0;
+protected:
+    void xChanged() override { changes++; }
+    void yChanged() override { changes++; }
+};
+
+class PropertyBatchTest : public ::testing::Test {
+public:
+    ComponentHandle<ProbeNode> handle(ProbeNode& node) {
+        return ComponentHandle<ProbeNode>(&index, &node, index.generation());
+    }
+public:
+    ComponentIndex index;
+    PropertyBatch batch;
+    ProbeNode node;
+};
+
+TEST_F(PropertyBatchTest, CoalescesWritesToAProperty) {
+    batch.set(handle(node), &rive::NodeBase::x, 1);
+    batch.set(handle(node), &rive::NodeBase::x, 2);
+    batch.set(handle(node), &rive::NodeBase::x, 3);
+    EXPECT_EQ(batch.size(), 1u);
+
+    batch.apply();
+    EXPECT_EQ(node.x(), 3.0f);
+    EXPECT_EQ(node.changes, 1);
+    EXPECT_EQ(batch.size(), 0u);
+}
+
+TEST_F(PropertyBatchTest, KeepsPropertiesAndComponentsApart) {
+    ProbeNode other;
+    batch.set(handle(node), &rive::NodeBase::x, 1);
+    batch.set(handle(node), &rive::NodeBase::y, 2);
+    batch.set(handle(other), &rive::NodeBase::x, 3);
+    EXPECT_EQ(batch.size(), 3u);
+
+    batch.apply();
+    EXPECT_EQ(node.x(), 1.0f);
+    EXPECT_EQ(node.y(), 2.0f);
+    EXPECT_EQ(other.x(), 3.0f);
+}
+
+TEST_F(PropertyBatchTest, SkipsStaleHandles) {
+    batch.set(handle(node), &rive::NodeBase::x, 1);
+    batch.set(ComponentHandle<ProbeNode>(), &rive::NodeBase::y, 2);
+    EXPECT_EQ(batch.size(), 1u);
+
+    // Rebuilding the index for another artboard invalidates the handle.
+    index.clear();
+    batch.apply();
+    EXPECT_EQ(node.changes, 0);
+}
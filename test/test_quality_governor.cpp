@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+
+#include "rive_tizen.hpp"
+
+using namespace rive_tizen;
+
+class QualityGovernorTest : public ::testing::Test {
+public:
+    // Frames fed until the tier changes, -1 when it didn't within limit.
+    int framesUntilChange(double milliseconds, int limit) {
+        for (int frame = 1; frame <= limit; frame++) {
+            if (governor.sample(milliseconds)) {
+                return frame;
+            }
+        }
+        return -1;
+    }
+public:
+    QualityGovernor governor;
+};
+
+TEST_F(QualityGovernorTest, OffByDefault) {
+    EXPECT_EQ(framesUntilChange(100, 200), -1);
+    EXPECT_EQ(governor.tier(), 0);
+    EXPECT_TRUE(governor.history().empty());
+}
+
+TEST_F(QualityGovernorTest, StepsDownAfterSustainedOverrun) {
+    governor.budget(16);
+    EXPECT_EQ(framesUntilChange(32, 100), 8);
+    EXPECT_EQ(governor.tier(), 1);
+    EXPECT_EQ(framesUntilChange(32, 100), 8);
+    EXPECT_EQ(governor.tier(), 2);
+}
+
+TEST_F(QualityGovernorTest, IgnoresASingleHitch) {
+    governor.budget(16);
+    for (int i = 0; i < 20; i++) {
+        governor.sample(8);
+    }
+    // Well past the frames a sustained overrun takes to step down.
+    governor.sample(200);
+    EXPECT_EQ(framesUntilChange(8, 30), -1);
+    EXPECT_EQ(governor.tier(), 0);
+}
+
+TEST_F(QualityGovernorTest, IgnoresAHitchOnAFreshAverage) {
+    governor.budget(16);
+    // The first frame sets the average on its own.
+    governor.sample(200);
+    EXPECT_EQ(framesUntilChange(8, 30), -1);
+    EXPECT_EQ(governor.tier(), 0);
+}
+
+TEST_F(QualityGovernorTest, StepsDownUnderUnevenOverrun) {
+    governor.budget(16);
+    int frames = 0;
+    for (; frames < 100 && governor.tier() == 0; frames++) {
+        governor.sample(frames % 2 ? 8 : 40);
+    }
+    EXPECT_EQ(governor.tier(), 1);
+    EXPECT_LE(frames, 24);
+}
+
+TEST_F(QualityGovernorTest, StopsAtTheLowestTier) {
+    governor.budget(16);
+    EXPECT_EQ(framesUntilChange(100, 1000), 8);
+    EXPECT_EQ(framesUntilChange(100, 1000), 8);
+    EXPECT_EQ(framesUntilChange(100, 1000), 8);
+    // MaxTier has no out of line definition, compare a copy.
+    int maxTier = QualityGovernor::MaxTier;
+    EXPECT_EQ(governor.tier(), maxTier);
+    EXPECT_EQ(framesUntilChange(100, 1000), -1);
+}
+
+TEST_F(QualityGovernorTest, StepsBackUpWithHeadroom) {
+    governor.budget(16);
+    framesUntilChange(32, 100);
+    ASSERT_EQ(governor.tier(), 1);
+
+    // The new tier is judged on its own frames, not on the average that led to it.
+    EXPECT_EQ(framesUntilChange(4, 1000), 90);
+    EXPECT_EQ(governor.tier(), 0);
+
+    // Between the headroom and the budget nothing moves.
+    EXPECT_EQ(framesUntilChange(14, 1000), -1);
+}
+
+TEST_F(QualityGovernorTest, RecordsHistory) {
+    governor.budget(16);
+    framesUntilChange(32, 100);
+    framesUntilChange(4, 1000);
+
+    auto& history = governor.history();
+    ASSERT_EQ(history.size(), 2u);
+    EXPECT_EQ(history[0].tier, 1);
+    EXPECT_EQ(history[0].frame, 8u);
+    EXPECT_GT(history[0].cost, 16);
+    EXPECT_EQ(history[1].tier, 0);
+    EXPECT_LT(history[1].cost, 16 * 0.7);
+}
+
+TEST_F(QualityGovernorTest, TurningOffRestoresFullQuality) {
+    governor.budget(16);
+    framesUntilChange(32, 100);
+    ASSERT_EQ(governor.tier(), 1);
+
+    governor.budget(0);
+    EXPECT_EQ(governor.tier(), 0);
+    EXPECT_EQ(governor.history().back().tier, 0);
+}
@@ -0,0 +1,652 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "tvg_renderer.hpp"
+
+using namespace rive;
+
+// Renders frames through the retained renderer and compares its pixels
+// against the same draws pushed straight to a fresh canvas, which goes
+// through none of the caches, culling or layers.
+class RendererTest : public ::testing::Test {
+public:
+    static const int Width = 64;
+    static const int Height = 64;
+
+    typedef std::function<void(TvgRenderer&)> Frame;
+
+    void SetUp() {
+        tvg::Initializer::init(tvg::CanvasEngine::Sw, 0);
+        pixels.assign(Width * Height, 0);
+        reference.assign(Width * Height, 0);
+        canvas = tvg::SwCanvas::gen();
+        canvas->target(pixels.data(), Width, Width, Height, tvg::SwCanvas::ARGB8888);
+        renderer = std::make_unique<TvgRenderer>(canvas.get(), true);
+        renderer->viewport(Width, Height);
+    }
+    void TearDown() {
+        renderer.reset();
+        canvas.reset();
+        tvg::Initializer::term(tvg::CanvasEngine::Sw);
+    }
+
+    static void rect(TvgRenderPath& path, float x, float y, float w, float h) {
+        path.reset();
+        path.moveTo(x, y);
+        path.lineTo(x + w, y);
+        path.lineTo(x + w, y + h);
+        path.lineTo(x, y + h);
+        path.close();
+    }
+
+    // Never mistaken for a rectangle.
+    static void diamond(TvgRenderPath& path, float cx, float cy, float r) {
+        path.reset();
+        path.moveTo(cx, cy - r);
+        path.lineTo(cx + r, cy);
+        path.lineTo(cx, cy + r);
+        path.lineTo(cx - r, cy);
+        path.close();
+    }
+
+    static void fill(TvgRenderPaint& paint, unsigned int color) {
+        paint.style(RenderPaintStyle::fill);
+        paint.color(color);
+    }
+
+    static void stroke(TvgRenderPaint& paint, unsigned int color, float thickness) {
+        paint.style(RenderPaintStyle::stroke);
+        paint.color(color);
+        paint.thickness(thickness);
+        paint.join(rive::StrokeJoin::round);
+        paint.cap(rive::StrokeCap::round);
+    }
+
+    static Mat2D translation(float x, float y) {
+        Mat2D transform;
+        transform[4] = x;
+        transform[5] = y;
+        return transform;
+    }
+
+    void draw(const Frame& frame) {
+        renderer->beginFrame();
+        frame(*renderer);
+        renderer->flush();
+        canvas->draw();
+        canvas->sync();
+    }
+
+    void drawReference(const Frame& frame) {
+        std::fill(reference.begin(), reference.end(), 0);
+        auto target = tvg::SwCanvas::gen();
+        target->target(reference.data(), Width, Width, Height, tvg::SwCanvas::ARGB8888);
+        {
+            TvgRenderer immediate(target.get());
+            frame(immediate);
+        }
+        target->draw();
+        target->sync();
+    }
+
+    // Reference drawn with thorvg directly, for what the renderer itself changes.
+    void drawRaw(const std::function<void(tvg::Canvas&)>& frame) {
+        std::fill(reference.begin(), reference.end(), 0);
+        auto target = tvg::SwCanvas::gen();
+        target->target(reference.data(), Width, Width, Height, tvg::SwCanvas::ARGB8888);
+        frame(*target);
+        target->draw();
+        target->sync();
+    }
+
+    static std::unique_ptr<tvg::Shape> rectMask(float x, float y, float w, float h) {
+        auto mask = tvg::Shape::gen();
+        mask->appendRect(x, y, w, h, 0, 0);
+        mask->fill(255, 255, 255, 255);
+        return mask;
+    }
+
+    // Largest difference of any channel between the two buffers.
+    int difference() const {
+        int largest = 0;
+        for (size_t i = 0; i < pixels.size(); i++) {
+            for (int shift = 0; shift < 32; shift += 8) {
+                int a = (pixels[i] >> shift) & 255;
+                int b = (reference[i] >> shift) & 255;
+                largest = std::max(largest, std::abs(a - b));
+            }
+        }
+        return largest;
+    }
+
+    // Both sides use the same rasterizer, only composition may round differently.
+    void expectSame(const Frame& frame, int tolerance = 1) {
+        draw(frame);
+        drawReference(frame);
+        EXPECT_LE(difference(), tolerance);
+    }
+
+    uint32_t pixel(int x, int y) const {
+        return pixels[y * Width + x];
+    }
+
+public:
+    std::vector<uint32_t> pixels;
+    std::vector<uint32_t> reference;
+    std::unique_ptr<tvg::SwCanvas> canvas;
+    std::unique_ptr<TvgRenderer> renderer;
+};
+
+TEST_F(RendererTest, CachedStrokeMatchesUncachedDraws) {
+    TvgRenderPath path;
+    TvgRenderPaint paint;
+    diamond(path, 24, 24, 12);
+    stroke(paint, 0xFF0000FF, 4);
+
+    static const unsigned int Colors[] = {0xFF0000FF, 0xFF00FF00, 0x80FF0000, 0xFF0000FF};
+    for (int i = 0; i < 12; i++) {
+        SCOPED_TRACE(i);
+        // Color, transform, thickness and geometry change at different paces.
+        paint.color(Colors[i % 4]);
+        if (i == 6) paint.thickness(7);
+        if (i == 9) diamond(path, 30, 30, 10);
+        auto offset = (i / 2) % 2 ? 8.0f : 0.0f;
+        expectSame([&](TvgRenderer& target) {
+            target.save();
+            target.transform(translation(offset, offset));
+            target.drawPath(&path, &paint);
+            target.restore();
+        });
+    }
+}
+
+TEST_F(RendererTest, CachedStrokeDrawnTwiceInAFrame) {
+    TvgRenderPath path;
+    TvgRenderPaint paint;
+    diamond(path, 16, 16, 10);
+    stroke(paint, 0xFF00FF00, 3);
+
+    for (int i = 0; i < 5; i++) {
+        // The second draw can't reuse the shape already in the frame.
+        expectSame([&](TvgRenderer& target) {
+            target.drawPath(&path, &paint);
+            target.save();
+            target.transform(translation(28, 28));
+            target.drawPath(&path, &paint);
+            target.restore();
+        });
+    }
+}
+
+TEST_F(RendererTest, AnimatedStrokeKeepsNoCopy) {
+    TvgRenderPath path;
+    TvgRenderPaint paint;
+    stroke(paint, 0xFFFFFFFF, 2);
+
+    for (int i = 0; i < 8; i++) {
+        diamond(path, 32, 32, 8 + i);
+        draw([&](TvgRenderer& target) { target.drawPath(&path, &paint); });
+        EXPECT_EQ(path.bytes(), 0u);
+    }
+
+    // Once the geometry holds still the outline gets cached.
+    for (int i = 0; i < 4; i++) {
+        draw([&](TvgRenderer& target) { target.drawPath(&path, &paint); });
+    }
+    EXPECT_GT(path.bytes(), 0u);
+}
+
+TEST_F(RendererTest, SolidRectCrossingClipIsCutToTheClip) {
+    TvgRenderPath clip, path;
+    TvgRenderPaint paint;
+    rect(clip, 16, 16, 32, 32);
+    rect(path, 8, 8, 24, 24);
+    fill(paint, 0xFFFF8000);
+
+    draw([&](TvgRenderer& target) {
+        target.clipPath(&clip);
+        target.drawPath(&path, &paint);
+    });
+    drawRaw([&](tvg::Canvas& target) {
+        auto shape = tvg::Shape::gen();
+        shape->appendRect(8, 8, 24, 24, 0, 0);
+        shape->fill(255, 128, 0, 255);
+        shape->composite(rectMask(16, 16, 32, 32), tvg::CompositeMethod::ClipPath);
+        target.push(std::move(shape));
+    });
+    EXPECT_LE(difference(), 1);
+    EXPECT_EQ(pixel(20, 20), 0xFFFF8000u);
+    EXPECT_EQ(pixel(10, 10), 0u);
+}
+
+TEST_F(RendererTest, TransformedRectCrossingShapeClip) {
+    TvgRenderPath bounds, clip, path;
+    TvgRenderPaint paint;
+    rect(bounds, 0, 0, Width, Height);
+    rect(clip, 20, 0, 24, Height);
+    rect(path, 0, 0, 8, 8);
+    fill(paint, 0x80008000);
+
+    // The second clip applies to the next draw only.
+    draw([&](TvgRenderer& target) {
+        target.clipPath(&bounds);
+        target.clipPath(&clip);
+        target.save();
+        Mat2D transform;
+        transform[0] = 4;
+        transform[3] = 2;
+        transform[4] = 8;
+        transform[5] = 16;
+        target.transform(transform);
+        target.drawPath(&path, &paint);
+        target.drawPath(&path, &paint);
+        target.restore();
+    });
+    drawRaw([&](tvg::Canvas& target) {
+        auto first = tvg::Shape::gen();
+        first->appendRect(8, 16, 32, 16, 0, 0);
+        first->fill(0, 128, 0, 128);
+        first->composite(rectMask(20, 0, 24, Height), tvg::CompositeMethod::ClipPath);
+        target.push(std::move(first));
+        auto second = tvg::Shape::gen();
+        second->appendRect(8, 16, 32, 16, 0, 0);
+        second->fill(0, 128, 0, 128);
+        target.push(std::move(second));
+    });
+    EXPECT_LE(difference(), 1);
+}
+
+TEST_F(RendererTest, MaskedDrawsCrossingClip) {
+    TvgRenderPath clip, shape, box;
+    TvgRenderPaint outline, gradient;
+    rect(clip, 16, 16, 32, 32);
+    diamond(shape, 16, 16, 12);
+    rect(box, 32, 32, 24, 24);
+    stroke(outline, 0xFF00FFFF, 4);
+    gradient.style(RenderPaintStyle::fill);
+    gradient.linearGradient(32, 32, 56, 56);
+    gradient.addStop(0xFFFF0000, 0);
+    gradient.addStop(0xFF0000FF, 1);
+    gradient.completeGradient();
+
+    // Strokes and gradients still need the mask, a plain rectangle one.
+    auto frame = [&](TvgRenderer& target) {
+        target.clipPath(&clip);
+        target.drawPath(&shape, &outline);
+        target.drawPath(&box, &gradient);
+    };
+    for (int i = 0; i < 5; i++) {
+        SCOPED_TRACE(i);
+        draw(frame);
+        drawRaw([&](tvg::Canvas& target) {
+            auto stroked = tvg::Shape::gen();
+            stroked->moveTo(16, 4);
+            stroked->lineTo(28, 16);
+            stroked->lineTo(16, 28);
+            stroked->lineTo(4, 16);
+            stroked->close();
+            stroked->stroke(tvg::StrokeCap::Round);
+            stroked->stroke(tvg::StrokeJoin::Round);
+            stroked->stroke(4);
+            stroked->stroke(0, 255, 255, 255);
+            stroked->composite(rectMask(16, 16, 32, 32), tvg::CompositeMethod::ClipPath);
+            target.push(std::move(stroked));
+
+            auto filled = tvg::Shape::gen();
+            filled->appendRect(32, 32, 24, 24, 0, 0);
+            auto fill = tvg::LinearGradient::gen();
+            fill->linear(32, 32, 56, 56);
+            tvg::Fill::ColorStop stops[] = {{0, 255, 0, 0, 255}, {1, 0, 0, 255, 255}};
+            fill->colorStops(stops, 2);
+            filled->fill(std::move(fill));
+            filled->composite(rectMask(16, 16, 32, 32), tvg::CompositeMethod::ClipPath);
+            target.push(std::move(filled));
+        });
+        EXPECT_LE(difference(), 1);
+    }
+}
+
+TEST_F(RendererTest, CoveredFrameMatchesUnculledDraws) {
+    TvgRenderPath below, cover, above;
+    TvgRenderPaint belowPaint, coverPaint, abovePaint;
+    diamond(below, 20, 20, 16);
+    rect(cover, 0, 0, Width, Height);
+    diamond(above, 40, 40, 10);
+    fill(belowPaint, 0xFFFF0000);
+    fill(coverPaint, 0xFF102030);
+    fill(abovePaint, 0x8000FF00);
+
+    // The cover comes and goes, the frame below it must come back.
+    for (int i = 0; i < 4; i++) {
+        SCOPED_TRACE(i);
+        expectSame([&](TvgRenderer& target) {
+            target.drawPath(&below, &belowPaint);
+            if (i % 2 == 0) target.drawPath(&cover, &coverPaint);
+            target.drawPath(&above, &abovePaint);
+        });
+    }
+}
+
+TEST_F(RendererTest, PartlyOccludedDraws) {
+    TvgRenderPath inside, crossing, occluder, translucent;
+    TvgRenderPaint red, green, blue, white;
+    diamond(inside, 32, 32, 8);
+    diamond(crossing, 16, 16, 12);
+    rect(occluder, 16, 16, 32, 32);
+    rect(translucent, 24, 24, 32, 32);
+    fill(red, 0xFFFF0000);
+    fill(green, 0xFF00FF00);
+    fill(blue, 0xFF0000FF);
+    fill(white, 0x80FFFFFF);
+
+    expectSame([&](TvgRenderer& target) {
+        target.drawPath(&inside, &red);
+        target.drawPath(&crossing, &green);
+        target.drawPath(&occluder, &blue);
+        target.drawPath(&translucent, &white);
+    });
+}
+
+TEST_F(RendererTest, ClippedOccluderHidesOnlyTheClippedArea) {
+    TvgRenderPath clip, below, occluder;
+    TvgRenderPaint red, blue;
+    rect(clip, 0, 0, 32, Height);
+    diamond(below, 40, 32, 12);
+    rect(occluder, 0, 0, Width, Height);
+    fill(red, 0xFFFF0000);
+    fill(blue, 0xFF0000FF);
+
+    expectSame([&](TvgRenderer& target) {
+        target.drawPath(&below, &red);
+        target.clipPath(&clip);
+        target.drawPath(&occluder, &blue);
+    });
+}
+
+TEST_F(RendererTest, IdenticalPathsShareGeometry) {
+    TvgRenderPath first, second, other;
+    TvgRenderPaint paint;
+    diamond(first, 16, 16, 8);
+    diamond(second, 16, 16, 8);
+    diamond(other, 40, 40, 8);
+    fill(paint, 0xFFFFFFFF);
+
+    expectSame([&](TvgRenderer& target) {
+        target.drawPath(&first, &paint);
+        target.save();
+        target.transform(translation(24, 0));
+        target.drawPath(&second, &paint);
+        target.restore();
+        target.drawPath(&other, &paint);
+    });
+    EXPECT_EQ(first.geometry, second.geometry);
+    EXPECT_NE(first.geometry, other.geometry);
+    EXPECT_TRUE(first.geometry->pooled);
+}
+
+TEST_F(RendererTest, AnimatedPathStaysOutOfThePool) {
+    TvgRenderPath path, twin;
+    TvgRenderPaint paint;
+    fill(paint, 0xFF00FF00);
+
+    for (int i = 0; i < 6; i++) {
+        SCOPED_TRACE(i);
+        diamond(path, 32, 32, 8 + i);
+        expectSame([&](TvgRenderer& target) { target.drawPath(&path, &paint); });
+        // Only the first change can't tell an animation yet.
+        EXPECT_EQ(path.geometry->pooled, i == 0);
+    }
+
+    // Holding still it shares again.
+    diamond(twin, 32, 32, 13);
+    expectSame([&](TvgRenderer& target) {
+        target.drawPath(&path, &paint);
+        target.drawPath(&twin, &paint);
+    });
+    EXPECT_TRUE(path.geometry->pooled);
+    EXPECT_EQ(path.geometry, twin.geometry);
+}
+
+TEST_F(RendererTest, RestoredTransformsMatchUncachedDraws) {
+    TvgRenderPath path;
+    TvgRenderPaint outline, solid;
+    diamond(path, 12, 12, 8);
+    stroke(outline, 0xFF0000FF, 3);
+    fill(solid, 0x8000FF00);
+
+    for (int i = 0; i < 8; i++) {
+        SCOPED_TRACE(i);
+        // The inner transform moves every other frame, the outer one holds.
+        auto inner = i % 2 ? 16.0f : 20.0f;
+        expectSame([&](TvgRenderer& target) {
+            target.drawPath(&path, &outline);
+            target.save();
+            target.transform(translation(24, 0));
+            target.drawPath(&path, &outline);
+            target.save();
+            target.transform(translation(0, inner));
+            target.drawPath(&path, &outline);
+            target.drawPath(&path, &solid);
+            target.restore();
+            // Back to the outer transform and its cached outline.
+            target.drawPath(&path, &solid);
+            target.restore();
+            target.save();
+            target.transform(translation(0, 40));
+            target.drawPath(&path, &outline);
+            target.restore();
+        });
+    }
+}
+
+TEST_F(RendererTest, SavesDeeperThanTheStack) {
+    TvgRenderPath path;
+    TvgRenderPaint outline;
+    diamond(path, 8, 8, 6);
+    stroke(outline, 0xFFFF0000, 2);
+
+    for (int i = 0; i < 3; i++) {
+        draw([&](TvgRenderer& target) {
+            for (int depth = 0; depth < 80; depth++) {
+                target.save();
+                target.transform(translation(0.5f, 0.5f));
+            }
+            target.drawPath(&path, &outline);
+            for (int depth = 0; depth < 80; depth++) {
+                target.restore();
+            }
+            target.drawPath(&path, &outline);
+        });
+        drawReference([&](TvgRenderer& target) {
+            target.save();
+            target.transform(translation(40, 40));
+            target.drawPath(&path, &outline);
+            target.restore();
+            target.drawPath(&path, &outline);
+        });
+        EXPECT_LE(difference(), 1);
+    }
+}
+
+TEST_F(RendererTest, BakedLayerMatchesLiveDraws) {
+    TvgRenderPath first, second, third;
+    TvgRenderPaint outline, solid;
+    diamond(first, 16, 16, 10);
+    diamond(second, 32, 32, 10);
+    diamond(third, 48, 48, 10);
+    stroke(outline, 0xFF0000FF, 3);
+    fill(solid, 0x80FF8000);
+    renderer->layerBaking(true);
+
+    auto frame = [&](TvgRenderer& target) {
+        target.drawPath(&first, &solid);
+        target.drawPath(&second, &outline);
+        target.drawPath(&third, &solid);
+    };
+    for (int i = 0; i < 8; i++) {
+        SCOPED_TRACE(i);
+        // The blit rounds premultiplied colors once more.
+        expectSame(frame, 2);
+    }
+    EXPECT_GT(renderer->layerBytes(), 0u);
+
+    // A change drops the layer and draws live again.
+    solid.color(0xFF00FF00);
+    expectSame(frame, 2);
+    for (int i = 0; i < 8; i++) {
+        expectSame(frame, 2);
+    }
+    EXPECT_GT(renderer->layerBytes(), 0u);
+}
+
+TEST_F(RendererTest, ChangingDrawsAreNotBaked) {
+    TvgRenderPath still, moving;
+    TvgRenderPaint paint;
+    diamond(still, 16, 16, 10);
+    fill(paint, 0xFFFFFFFF);
+    renderer->layerBaking(true);
+
+    for (int i = 0; i < 8; i++) {
+        diamond(moving, 32 + i, 32, 10);
+        expectSame([&](TvgRenderer& target) {
+            target.drawPath(&still, &paint);
+            target.drawPath(&moving, &paint);
+            target.drawPath(&still, &paint);
+        });
+        EXPECT_EQ(renderer->layerBytes(), 0u);
+    }
+}
+
+TEST_F(RendererTest, EachArtboardClipsItsOwnDraws) {
+    TvgRenderPath below, main, above, shape, small;
+    TvgRenderPaint paint;
+    rect(below, 0, 0, 24, Height);
+    rect(main, 20, 0, 24, Height);
+    rect(above, 40, 0, 24, Height);
+    diamond(shape, 32, 32, 30);
+    diamond(small, 32, 16, 8);
+    fill(paint, 0x80FF0000);
+
+    // A placement below the main artboard, the main one and one above it,
+    // each clipped to its background and drawing twice.
+    draw([&](TvgRenderer& target) {
+        for (auto clip : {&below, &main, &above}) {
+            auto clips = target.resetClips();
+            target.save();
+            target.clipPath(clip);
+            target.drawPath(&shape, &paint);
+            target.drawPath(&small, &paint);
+            target.restore();
+            target.restoreClips(clips);
+        }
+    });
+    drawRaw([&](tvg::Canvas& target) {
+        for (float x : {0.0f, 20.0f, 40.0f}) {
+            for (auto path : {&shape, &small}) {
+                auto copy = std::unique_ptr<tvg::Shape>(static_cast<tvg::Shape*>(path->shape()->duplicate()));
+                copy->fill(255, 0, 0, 128);
+                copy->composite(rectMask(x, 0, 24, Height), tvg::CompositeMethod::ClipPath);
+                target.push(std::move(copy));
+            }
+        }
+    });
+    EXPECT_LE(difference(), 1);
+    // Where two artboards overlap both draw, nothing outside the clips.
+    EXPECT_NE(pixel(22, 32), pixel(10, 32));
+    EXPECT_EQ(pixel(2, 8), 0u);
+}
+
+#ifdef THORVG_BLEND_SUPPORT
+class BlendTest : public RendererTest {
+public:
+    void SetUp() {
+        RendererTest::SetUp();
+        rect(background, 0, 0, Width, Height);
+        fill(backgroundPaint, 0xFF0000FF);
+    }
+
+    // Blend mode draws of rects over an opaque blue background.
+    void drawBlended(BlendMode mode, std::vector<TvgRenderPath*> paths, std::vector<TvgRenderPaint*> paints) {
+        for (auto paint : paints) paint->blendMode(mode);
+        draw([&](TvgRenderer& target) {
+            target.drawPath(&background, &backgroundPaint);
+            for (size_t i = 0; i < paths.size(); i++) target.drawPath(paths[i], paints[i]);
+        });
+    }
+
+    // Channels within rounding of the expected ARGB color.
+    static bool near(uint32_t actual, uint32_t expected) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            if (std::abs(int((actual >> shift) & 255) - int((expected >> shift) & 255)) > 2) return false;
+        }
+        return true;
+    }
+
+public:
+    TvgRenderPath background;
+    TvgRenderPaint backgroundPaint;
+};
+
+TEST_F(BlendTest, LoneDrawBlends) {
+    TvgRenderPath path;
+    TvgRenderPaint paint;
+    rect(path, 8, 8, 16, 16);
+    fill(paint, 0xFFFF0000);
+
+    drawBlended(BlendMode::screen, {&path}, {&paint});
+    EXPECT_TRUE(near(pixel(16, 16), 0xFFFF00FF));
+    EXPECT_TRUE(near(pixel(40, 40), 0xFF0000FF));
+
+    drawBlended(BlendMode::multiply, {&path}, {&paint});
+    EXPECT_TRUE(near(pixel(16, 16), 0xFF000000));
+    EXPECT_TRUE(near(pixel(40, 40), 0xFF0000FF));
+}
+
+TEST_F(BlendTest, DisjointDrawsShareALayer) {
+    TvgRenderPath left, right;
+    TvgRenderPaint red, green;
+    rect(left, 4, 4, 24, 24);
+    rect(right, 32, 4, 24, 24);
+    fill(red, 0xFFFF0000);
+    fill(green, 0xFF00FF00);
+
+    drawBlended(BlendMode::screen, {&left, &right}, {&red, &green});
+    EXPECT_TRUE(near(pixel(16, 16), 0xFFFF00FF));
+    EXPECT_TRUE(near(pixel(44, 16), 0xFF00FFFF));
+    EXPECT_TRUE(near(pixel(30, 50), 0xFF0000FF));
+}
+
+TEST_F(BlendTest, DistantDrawsBlendApart) {
+    TvgRenderPath corner, opposite;
+    TvgRenderPaint red, green;
+    // The union would be mostly empty, each draw blends on its own.
+    rect(corner, 0, 0, 4, 4);
+    rect(opposite, 60, 60, 4, 4);
+    fill(red, 0xFFFF0000);
+    fill(green, 0xFF00FF00);
+
+    drawBlended(BlendMode::screen, {&corner, &opposite}, {&red, &green});
+    EXPECT_TRUE(near(pixel(2, 2), 0xFFFF00FF));
+    EXPECT_TRUE(near(pixel(62, 62), 0xFF00FFFF));
+    EXPECT_TRUE(near(pixel(32, 32), 0xFF0000FF));
+}
+
+TEST_F(BlendTest, OverlappingDrawsBlendInOrder) {
+    TvgRenderPath first, second;
+    TvgRenderPaint red, green;
+    rect(first, 8, 8, 32, 32);
+    rect(second, 24, 24, 32, 32);
+    fill(red, 0xFFFF0000);
+    fill(green, 0xFF00FF00);
+
+    // Green screens over the already screened red.
+    drawBlended(BlendMode::screen, {&first, &second}, {&red, &green});
+    EXPECT_TRUE(near(pixel(16, 16), 0xFFFF00FF));
+    EXPECT_TRUE(near(pixel(32, 32), 0xFFFFFFFF));
+    EXPECT_TRUE(near(pixel(48, 48), 0xFF00FFFF));
+}
+#endif
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#include "upscale.hpp"
+
+using namespace rive_tizen;
+
+// Premultiplied pixels, each color channel at most alpha.
+static std::vector<uint32_t> pixels(int width, int height)
+{
+    std::vector<uint32_t> result(static_cast<size_t>(width) * height);
+    srand(7);
+    for (auto& pixel : result) {
+        uint32_t alpha = rand() % 256;
+        uint32_t red = alpha ? rand() % (alpha + 1) : 0;
+        uint32_t green = alpha ? rand() % (alpha + 1) : 0;
+        uint32_t blue = alpha ? rand() % (alpha + 1) : 0;
+        pixel = alpha << 24 | red << 16 | green << 8 | blue;
+    }
+    return result;
+}
+
+// Source position sampled by destination position i, pixel centers aligned.
+static float sourcePosition(int i, int src, int dst)
+{
+    float position = (i + 0.5f) * src / dst - 0.5f;
+    return std::fmin(std::fmax(position, 0.0f), static_cast<float>(src - 1));
+}
+
+static float channel(const std::vector<uint32_t>& src, int width, int x, int y, int shift)
+{
+    return (src[static_cast<size_t>(y) * width + x] >> shift) & 0xff;
+}
+
+// Bilinear filter in float, what the fixed point passes approximate.
+static float reference(const std::vector<uint32_t>& src, int srcWidth, int srcHeight, int dstWidth,
+    int dstHeight, int x, int y, int shift)
+{
+    float sx = sourcePosition(x, srcWidth, dstWidth);
+    float sy = sourcePosition(y, srcHeight, dstHeight);
+    int x0 = static_cast<int>(sx), y0 = static_cast<int>(sy);
+    int x1 = std::min(x0 + 1, srcWidth - 1), y1 = std::min(y0 + 1, srcHeight - 1);
+    float fx = sx - x0, fy = sy - y0;
+    float top = channel(src, srcWidth, x0, y0, shift) * (1 - fx) + channel(src, srcWidth, x1, y0, shift) * fx;
+    float bottom = channel(src, srcWidth, x0, y1, shift) * (1 - fx) + channel(src, srcWidth, x1, y1, shift) * fx;
+    return top * (1 - fy) + bottom * fy;
+}
+
+static void expectBilinear(int srcWidth, int srcHeight, int dstWidth, int dstHeight)
+{
+    auto src = pixels(srcWidth, srcHeight);
+    // Padded rows, the padding must stay untouched.
+    int stride = dstWidth + 3;
+    std::vector<uint32_t> dst(static_cast<size_t>(stride) * dstHeight, 0xdeadbeef);
+
+    Upscaler upscaler;
+    upscaler.setup(srcWidth, srcHeight, dstWidth, dstHeight);
+    upscaler.run(src.data(), dst.data(), stride);
+
+    for (int y = 0; y < dstHeight; y++) {
+        for (int x = 0; x < dstWidth; x++) {
+            uint32_t pixel = dst[static_cast<size_t>(y) * stride + x];
+            for (int shift = 0; shift < 32; shift += 8) {
+                float expected = reference(src, srcWidth, srcHeight, dstWidth, dstHeight, x, y, shift);
+                // 7 bit weights and rounding in both passes.
+                ASSERT_NEAR((pixel >> shift) & 0xff, expected, 3.0f)
+                    << "at " << x << "," << y << " channel " << shift / 8;
+            }
+            // Still premultiplied.
+            ASSERT_LE((pixel >> 16) & 0xff, pixel >> 24);
+        }
+        for (int x = dstWidth; x < stride; x++) {
+            ASSERT_EQ(dst[static_cast<size_t>(y) * stride + x], 0xdeadbeefu);
+        }
+    }
+}
+
+TEST(UpscalerTest, SameSizeCopies) {
+    auto src = pixels(13, 7);
+    std::vector<uint32_t> dst(src.size());
+    Upscaler upscaler;
+    upscaler.setup(13, 7, 13, 7);
+    upscaler.run(src.data(), dst.data(), 13);
+    EXPECT_EQ(dst, src);
+}
+
+TEST(UpscalerTest, MatchesFloatReference) {
+    expectBilinear(48, 27, 64, 36);
+}
+
+TEST(UpscalerTest, OddSizesUseTheScalarTails) {
+    expectBilinear(7, 5, 19, 11);
+    expectBilinear(1, 1, 5, 3);
+}
+
+TEST(UpscalerTest, FlatColorStaysFlat) {
+    std::vector<uint32_t> src(30 * 20, 0x80402010);
+    std::vector<uint32_t> dst(40 * 30);
+    Upscaler upscaler;
+    upscaler.setup(30, 20, 40, 30);
+    upscaler.run(src.data(), dst.data(), 40);
+    for (auto pixel : dst) {
+        ASSERT_EQ(pixel, 0x80402010u);
+    }
+}
+
+TEST(UpscalerTest, ChangingTheSourceSizeKeepsWorking) {
+    Upscaler upscaler;
+    upscaler.setup(32, 32, 64, 64);
+    auto src = pixels(16, 16);
+    std::vector<uint32_t> dst(64 * 64);
+    upscaler.setup(16, 16, 64, 64);
+    upscaler.run(src.data(), dst.data(), 64);
+    // Corners sample the corner pixels alone.
+    EXPECT_EQ(dst[0], src[0]);
+    EXPECT_EQ(dst[64 * 64 - 1], src[16 * 16 - 1]);
+}